@@ -0,0 +1,313 @@
+/// Performance regression gate for the benchmark harness. Results are compared
+/// to a baseline (a JSON report of the harness, see `Harness::Report`) after
+/// normalizing every time by the calibration loop of the machine that
+/// measured it, so that a baseline recorded on one machine is comparable on
+/// another. Counters (e.g. instructions per value) do not depend on the
+/// speed of the machine and are compared as measured. A metric regresses if
+/// its normalized value grew by more than its relative tolerance. The tolerances are part of the baseline. Since timings
+/// of a busy machine are noisy, `Check` reruns the benchmarks when a metric
+/// regresses and compares the best normalized values of all runs.
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "harness.h"
+
+namespace bench {
+
+/// Minimal JSON document model and parser for reading baselines. Numbers are
+/// doubles, and objects keep their members in order.
+struct JSON {
+  enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+  Type type = Type::NUL;
+  bool boolean = false;
+  double number = 0.0;
+  std::string string;
+  std::vector<JSON> array;
+  std::vector<std::pair<std::string, JSON>> object;
+
+  // Returns the member with the given key, or nullptr if there is none
+  const JSON* find(const std::string& key) const {
+    for (const auto& [name, value]: object) {
+      if (name == key) {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+
+  static JSON Parse(const std::string& text) {
+    std::size_t i = 0;
+    JSON value = ParseValue(text, i);
+    SkipSpace(text, i);
+    if (i != text.size()) {
+      throw std::runtime_error("Unexpected JSON content at offset " + std::to_string(i) + ".");
+    }
+    return value;
+  }
+ private:
+  static void SkipSpace(const std::string& text, std::size_t& i) {
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) {
+      i++;
+    }
+  }
+
+  static void Expect(const std::string& text, std::size_t& i, char c) {
+    SkipSpace(text, i);
+    if (i == text.size() || text[i] != c) {
+      throw std::runtime_error(std::string("Expected '") + c + "' in JSON at offset " +
+                               std::to_string(i) + ".");
+    }
+    i++;
+  }
+
+  static std::string ParseString(const std::string& text, std::size_t& i) {
+    Expect(text, i, '"');
+    std::string value;
+    while (i < text.size() && text[i] != '"') {
+      if (text[i] == '\\' && i + 1 < text.size()) {
+        const char escaped = text[++i];
+        value += escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped;
+      } else {
+        value += text[i];
+      }
+      i++;
+    }
+    Expect(text, i, '"');
+    return value;
+  }
+
+  static JSON ParseValue(const std::string& text, std::size_t& i) {
+    SkipSpace(text, i);
+    if (i == text.size()) {
+      throw std::runtime_error("Unexpected end of JSON.");
+    }
+
+    JSON value;
+    const char c = text[i];
+    if (c == '{') {
+      value.type = Type::OBJECT;
+      i++;
+      SkipSpace(text, i);
+      if (text[i] == '}') {
+        i++;
+        return value;
+      }
+      do {
+        std::string key = ParseString(text, i);
+        Expect(text, i, ':');
+        value.object.emplace_back(std::move(key), ParseValue(text, i));
+        SkipSpace(text, i);
+      } while (i < text.size() && text[i] == ',' && ++i);
+      Expect(text, i, '}');
+    } else if (c == '[') {
+      value.type = Type::ARRAY;
+      i++;
+      SkipSpace(text, i);
+      if (text[i] == ']') {
+        i++;
+        return value;
+      }
+      do {
+        value.array.push_back(ParseValue(text, i));
+        SkipSpace(text, i);
+      } while (i < text.size() && text[i] == ',' && ++i);
+      Expect(text, i, ']');
+    } else if (c == '"') {
+      value.type = Type::STRING;
+      value.string = ParseString(text, i);
+    } else if (text.compare(i, 4, "true") == 0 || text.compare(i, 5, "false") == 0) {
+      value.type = Type::BOOLEAN;
+      value.boolean = c == 't';
+      i += value.boolean ? 4 : 5;
+    } else if (text.compare(i, 4, "null") == 0) {
+      i += 4;
+    } else {
+      char* end;
+      value.type = Type::NUMBER;
+      value.number = std::strtod(text.c_str() + i, &end);
+      if (end == text.c_str() + i) {
+        throw std::runtime_error("Invalid JSON value at offset " + std::to_string(i) + ".");
+      }
+      i = end - text.c_str();
+    }
+    return value;
+  }
+};
+
+class Baseline {
+ public:
+  // Reads a baseline written by the JSON report of the harness
+  explicit Baseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+      throw std::runtime_error("Cannot read baseline " + path + ".");
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    const JSON json = JSON::Parse(text.str());
+
+    const JSON* context = json.find("context");
+    const JSON* calibration = context ? context->find("calibration_ns") : nullptr;
+    const JSON* tolerances = json.find("tolerances");
+    const JSON* benchmarks = json.find("benchmarks");
+    if (!calibration || !tolerances || !benchmarks) {
+      throw std::runtime_error("Baseline " + path + " requires context.calibration_ns, "
+                               "tolerances and benchmarks.");
+    }
+
+    calibration_ns_ = calibration->number;
+    for (const auto& [metric, tolerance]: tolerances->object) {
+      tolerances_.emplace_back(metric, tolerance.number);
+    }
+    for (const JSON& benchmark: benchmarks->array) {
+      const JSON* name = benchmark.find("name");
+      if (!name) {
+        throw std::runtime_error("Baseline " + path + " has a benchmark without a name.");
+      }
+      std::map<std::string, double>& metrics = values_[name->string];
+      for (const auto& [metric, value]: benchmark.object) {
+        if (value.type == JSON::Type::NUMBER) {
+          metrics[metric] = value.number;
+        }
+      }
+    }
+  }
+
+  const std::vector<std::pair<std::string, double>>& tolerances() const { return tolerances_; }
+
+  // Runs the benchmarks of the harness up to `attempts` times until no metric
+  // regresses, writes the comparison of the best values, and returns whether
+  // no metric regressed
+  bool Check(Harness& harness, std::ostream& os, int attempts = 3) const {
+    std::vector<Result> best = harness.Run();
+    const double calibration_ns = harness.calibration_ns();
+    for (int attempt = 1;; ++attempt) {
+      std::ostringstream comparison;
+      const bool passed = Compare(best, calibration_ns, comparison);
+      if (passed || attempt == attempts) {
+        os << comparison.str();
+        return passed;
+      }
+
+      std::cerr << "Regression in run " << attempt << " of " << attempts << ", rerunning"
+                << std::endl;
+      const std::vector<Result> results = harness.Run();
+      // Scaled to the calibration of the first run
+      const double scale = calibration_ns / harness.calibration_ns();
+      for (std::size_t i = 0; i < best.size(); ++i) {
+        best[i].ns_per_value = std::min(best[i].ns_per_value, results[i].ns_per_value * scale);
+        best[i].min_ns_per_value =
+            std::min(best[i].min_ns_per_value, results[i].min_ns_per_value * scale);
+        for (std::size_t m = 0; m < best[i].metrics.size(); ++m) {
+          const auto& [metric, value] = results[i].metrics[m];
+          best[i].metrics[m].second =
+              std::min(best[i].metrics[m].second, IsTime(metric) ? value * scale : value);
+        }
+      }
+    }
+  }
+
+  // Compares results measured with the given calibration time to the baseline,
+  // writes a table of the compared metrics, and returns whether none regressed
+  bool Compare(const std::vector<Result>& results, double calibration_ns,
+               std::ostream& os) const {
+    std::map<std::string, const Result*> measured;
+    for (const Result& result: results) {
+      measured[result.name] = &result;
+    }
+
+    std::size_t width = 9;
+    for (const auto& [name, metrics]: values_) {
+      width = std::max(width, name.size());
+    }
+
+    os << "Calibration: " << std::fixed << std::setprecision(3) << calibration_ns
+       << " ns (baseline " << calibration_ns_ << " ns)" << std::endl
+       << std::left << std::setw(width) << "Benchmark" << std::setw(20) << "  Metric"
+       << std::right << std::setw(12) << "Baseline" << std::setw(12) << "Current"
+       << std::setw(10) << "Change" << std::setw(10) << "Limit" << "  Status" << std::endl
+       << std::string(width + 72, '-') << std::endl;
+
+    bool passed = true;
+    for (const auto& [name, metrics]: values_) {
+      const auto it = measured.find(name);
+      if (it == measured.end()) {
+        os << std::left << std::setw(width) << name << "  (not measured)" << std::right
+           << std::string(54, ' ') << "  MISSING" << std::endl;
+        passed = false;
+        continue;
+      }
+
+      for (const auto& [metric, tolerance]: tolerances_) {
+        const auto expected = metrics.find(metric);
+        const double* value = Metric(*it->second, metric);
+        if (expected == metrics.end() || value == nullptr) {
+          continue;
+        }
+
+        // Times of the current machine are scaled to the calibration of the
+        // baseline, counters are compared as measured
+        const double baseline = expected->second;
+        const double current =
+            IsTime(metric) ? *value / calibration_ns * calibration_ns_ : *value;
+        const double change = current / baseline - 1.0;
+        const bool regressed = change > tolerance;
+        passed = passed && !regressed;
+
+        os << std::left << std::setw(width) << name << "  " << std::setw(18) << metric
+           << std::right << std::setprecision(3) << std::setw(12) << baseline
+           << std::setw(12) << current << std::setprecision(1) << std::setw(9)
+           << std::showpos << 100 * change << '%' << std::setw(9) << 100 * tolerance
+           << std::noshowpos << "%  " << (regressed ? "REGRESSED"
+                                          : change < -tolerance ? "improved" : "ok")
+           << std::endl;
+      }
+    }
+    return passed;
+  }
+ private:
+  // Returns whether a metric is a time in nanoseconds (e.g. ns_per_value or
+  // p99_ns), which scales with the calibration, rather than a counter
+  static bool IsTime(const std::string& metric) {
+    const auto ends_with = [&metric](const std::string& suffix) {
+      return metric.size() >= suffix.size()
+          && metric.compare(metric.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return ends_with("ns_per_value") || ends_with("_ns");
+  }
+
+  // Returns the metric of a result with the given name, or nullptr
+  static const double* Metric(const Result& result, const std::string& metric) {
+    if (metric == "ns_per_value") {
+      return &result.ns_per_value;
+    } else if (metric == "min_ns_per_value") {
+      return &result.min_ns_per_value;
+    }
+    for (const auto& [name, value]: result.metrics) {
+      if (name == metric) {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+
+  double calibration_ns_;
+  std::vector<std::pair<std::string, double>> tolerances_;
+  std::map<std::string, std::map<std::string, double>> values_;
+};
+
+} // namespace bench
@@ -0,0 +1,420 @@
+/// Minimal benchmark harness for the examples, in the style of Google Benchmark.
+/// A benchmark is a function that generates at least a requested number of
+/// values. The harness grows that number until a run takes at least the
+/// minimum time, repeats the run, and reports the median (and minimum) time
+/// per value with the derived values/second and bytes/second. Optionally,
+/// hardware performance counters (see perf.h) are read around the repetitions
+/// and reported per value. In latency mode, every call is timed instead and
+/// the percentiles of a latency histogram (see latency.h) are reported.
+/// Results are printed as a console table, CSV or JSON.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "latency.h"
+#include "perf.h"
+
+namespace bench {
+
+// Prevents the compiler from optimizing away the computation of `value`
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+// Prevents the compiler from optimizing away writes to memory
+inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+// Ordered (key, value) pairs that describe a benchmark e.g. its engine
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+struct Benchmark {
+  std::string name;
+  Labels labels;
+  // Size of a generated value in bytes
+  std::size_t value_bytes;
+  // Generates at least the given number of values and returns the number of
+  // values generated
+  std::function<std::uint64_t(std::uint64_t)> run;
+  // Makes the given number of calls, records the ticks of each call in the
+  // histogram, and returns the number of values generated
+  std::function<std::uint64_t(std::uint64_t, LatencyHistogram&)> sample;
+  // Returns additional metrics of the benchmark after it is measured (optional)
+  std::function<std::vector<std::pair<std::string, double>>()> metrics;
+};
+
+struct Result {
+  std::string name;
+  Labels labels;
+  // Number of values of each repetition
+  std::uint64_t values;
+  std::size_t repetitions;
+  // Median and minimum over the repetitions
+  double ns_per_value;
+  double min_ns_per_value;
+  std::size_t value_bytes;
+  // Additional named measurements e.g. performance counters per value or
+  // latency percentiles
+  std::vector<std::pair<std::string, double>> metrics;
+
+  double values_per_second() const { return 1e9 / ns_per_value; }
+  double bytes_per_second() const { return values_per_second() * value_bytes; }
+};
+
+struct Options {
+  // Minimum time of a repetition in seconds
+  double min_time = 0.1;
+  std::size_t repetitions = 3;
+  // Only benchmarks whose name contains the filter (or one of its
+  // alternatives separated by '|') are run
+  std::string filter;
+  // console, csv or json
+  std::string format = "console";
+  // Whether to read hardware performance counters
+  bool counters = false;
+  // Whether to time every call instead of runs of calls
+  bool latency = false;
+  // Name of the unit of work in the console table e.g. "event"
+  std::string unit = "value";
+  // Relative tolerances of metrics for a regression gate (see baseline.h),
+  // which are written with JSON reports
+  std::vector<std::pair<std::string, double>> tolerances;
+};
+
+// Returns the time of an iteration of a fixed dependent chain of integer
+// operations (Splitmix64) in nanoseconds, the minimum of several runs. Times
+// divided by the calibration are comparable across machines.
+inline double Calibrate() {
+  constexpr std::uint64_t iterations = 10'000'000;
+  double best = 0.0;
+  for (int run = 0; run < 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t z = std::uint64_t(run);
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+      z += 0x9e3779b97f4a7c15;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      z ^= z >> 31;
+    }
+    DoNotOptimize(z);
+    const double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / iterations;
+    best = run == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+class Harness {
+ public:
+  explicit Harness(Options options) : options_(std::move(options)) {
+    if (options_.format != "console" && options_.format != "csv" && options_.format != "json") {
+      throw std::invalid_argument("Unknown format " + options_.format + ".");
+    }
+    if (options_.latency) {
+      // Latencies include the time of reading the timer, which is reported
+      LatencyHistogram histogram;
+      for (int i = 0; i < 100000; ++i) {
+        const std::uint64_t start = Ticks::Now();
+        histogram.Record(Ticks::Now() - start);
+      }
+      timer_ns_ = histogram.Percentile(50) * Ticks::Nanoseconds();
+      std::cerr << "Timer overhead: " << timer_ns_ << " ns" << std::endl;
+    }
+    if (options_.counters) {
+      counters_ = std::make_unique<PerfCounters>();
+      if (!counters_->available()) {
+        std::cerr << "Performance counters are unavailable (" << counters_->error() << ")"
+                  << std::endl;
+        counters_.reset();
+      }
+    }
+  }
+
+  const Options& options() const { return options_; }
+
+  void Add(Benchmark benchmark) {
+    if (options_.latency && !benchmark.sample) {
+      return;
+    }
+    for (std::size_t begin = 0; begin <= options_.filter.size();) {
+      const std::size_t end = std::min(options_.filter.find('|', begin), options_.filter.size());
+      if (benchmark.name.find(options_.filter.substr(begin, end - begin)) != std::string::npos) {
+        benchmarks_.push_back(std::move(benchmark));
+        return;
+      }
+      begin = end + 1;
+    }
+  }
+
+  // Returns the calibration time of the last run (see `Calibrate`)
+  double calibration_ns() const { return calibration_ns_; }
+
+  // Runs the benchmarks in the order they were added, with progress on stderr
+  std::vector<Result> Run() {
+    calibration_ns_ = Calibrate();
+    std::vector<Result> results;
+    for (std::size_t i = 0; i < benchmarks_.size(); ++i) {
+      std::cerr << "\r[" << i + 1 << "/" << benchmarks_.size() << "] "
+                << benchmarks_[i].name << "\x1b[K" << std::flush;
+      results.push_back(options_.latency ? Sample(benchmarks_[i]) : Measure(benchmarks_[i]));
+      if (benchmarks_[i].metrics) {
+        for (auto& metric: benchmarks_[i].metrics()) {
+          results.back().metrics.push_back(std::move(metric));
+        }
+      }
+    }
+    std::cerr << "\r\x1b[K" << std::flush;
+    return results;
+  }
+
+  // Writes the results in the format of the options
+  void Report(const std::vector<Result>& results, std::ostream& os) const {
+    if (options_.format == "csv") {
+      ReportCSV(results, os);
+    } else if (options_.format == "json") {
+      ReportJSON(results, os);
+    } else {
+      ReportConsole(results, os);
+    }
+  }
+ private:
+  using clock = std::chrono::steady_clock;
+
+  static std::pair<std::uint64_t, double> Time(const Benchmark& benchmark,
+                                               std::uint64_t values) {
+    const clock::time_point start = clock::now();
+    const std::uint64_t generated = benchmark.run(values);
+    const clock::time_point stop = clock::now();
+    return {generated, std::chrono::duration<double>(stop - start).count()};
+  }
+
+  Result Measure(const Benchmark& benchmark) const {
+    // Grows the number of values until a run takes the minimum time
+    std::uint64_t values = 1;
+    while (true) {
+      const auto [generated, seconds] = Time(benchmark, values);
+      if (seconds >= options_.min_time) {
+        values = generated;
+        break;
+      }
+      const double scale = seconds > 0 ? 1.4 * options_.min_time / seconds : 10;
+      values = std::max(generated + 1, std::uint64_t(generated * std::min(scale, 10.0)));
+    }
+
+    std::vector<double> times;
+    std::vector<double> counts(counters_ ? counters_->names().size() : 0);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < std::max<std::size_t>(options_.repetitions, 1); ++i) {
+      if (counters_) {
+        counters_->Start();
+      }
+      const auto [generated, seconds] = Time(benchmark, values);
+      if (counters_) {
+        const std::vector<double> repetition = counters_->Stop();
+        std::transform(counts.begin(), counts.end(), repetition.begin(), counts.begin(),
+                       std::plus<double>());
+      }
+      times.push_back(seconds * 1e9 / generated);
+      total += generated;
+    }
+    std::sort(times.begin(), times.end());
+
+    Result result{benchmark.name, benchmark.labels, values, times.size(),
+                  times[times.size() / 2], times.front(), benchmark.value_bytes, {}};
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+      result.metrics.emplace_back(counters_->names()[i] + "_per_value", counts[i] / total);
+    }
+    return result;
+  }
+
+  // Times calls (in growing rounds) for the minimum time of all repetitions
+  Result Sample(const Benchmark& benchmark) const {
+    LatencyHistogram warmup;
+    benchmark.sample(1, warmup);
+
+    const double duration = options_.min_time * std::max<std::size_t>(options_.repetitions, 1);
+    LatencyHistogram histogram;
+    std::vector<double> counts(counters_ ? counters_->names().size() : 0);
+    std::uint64_t values = 0;
+    const clock::time_point start = clock::now();
+    for (std::uint64_t calls = 1;
+         std::chrono::duration<double>(clock::now() - start).count() < duration;
+         calls = std::min<std::uint64_t>(2 * calls, 1 << 16)) {
+      if (counters_) {
+        counters_->Start();
+      }
+      values += benchmark.sample(calls, histogram);
+      if (counters_) {
+        const std::vector<double> round = counters_->Stop();
+        std::transform(counts.begin(), counts.end(), round.begin(), counts.begin(),
+                       std::plus<double>());
+      }
+    }
+
+    const double tick = Ticks::Nanoseconds();
+    const double per_call = double(values) / double(histogram.count());
+    Result result{benchmark.name, benchmark.labels, values, 1,
+                  histogram.mean() * tick / per_call, histogram.min() * tick / per_call,
+                  benchmark.value_bytes, {}};
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+      result.metrics.emplace_back(counters_->names()[i] + "_per_value", counts[i] / values);
+    }
+    for (const auto& [name, percent]: {std::pair("p50_ns", 50.0), std::pair("p99_ns", 99.0),
+                                       std::pair("p99.9_ns", 99.9)}) {
+      result.metrics.emplace_back(name, histogram.Percentile(percent) * tick);
+    }
+    result.metrics.emplace_back("max_ns", histogram.max() * tick);
+    return result;
+  }
+
+  static std::string Escape(const std::string& text) {
+    std::string escaped;
+    for (const char c: text) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  void ReportConsole(const std::vector<Result>& results, std::ostream& os) const {
+    std::size_t width = 9;
+    for (const Result& result: results) {
+      width = std::max(width, result.name.size());
+    }
+
+    os << std::left << std::setw(width) << "Benchmark" << std::right
+       << std::setw(14) << "ns/" + options_.unit << std::setw(14) << "M" + options_.unit + "s/s"
+       << std::setw(12) << "GB/s";
+    const std::vector<std::pair<std::string, double>> none;
+    const auto& metrics = results.empty() ? none : results.front().metrics;
+    for (const auto& [name, value]: metrics) {
+      os << std::setw(20) << name;
+    }
+    os << std::endl << std::string(width + 40 + 20 * metrics.size(), '-') << std::endl;
+    for (const Result& result: results) {
+      os << std::left << std::setw(width) << result.name << std::right << std::fixed
+         << std::setprecision(3) << std::setw(14) << result.ns_per_value
+         << std::setprecision(2) << std::setw(14) << result.values_per_second() / 1e6
+         << std::setprecision(3) << std::setw(12) << result.bytes_per_second() / 1e9;
+      for (const auto& [name, value]: result.metrics) {
+        os << std::setw(20) << value;
+      }
+      os << std::endl;
+    }
+  }
+
+  static void ReportCSV(const std::vector<Result>& results, std::ostream& os) {
+    os << "name";
+    if (!results.empty()) {
+      for (const auto& [key, value]: results.front().labels) {
+        os << ',' << key;
+      }
+    }
+    os << ",values,repetitions,ns_per_value,min_ns_per_value,values_per_second,"
+          "bytes_per_second";
+    if (!results.empty()) {
+      for (const auto& [name, value]: results.front().metrics) {
+        os << ',' << name;
+      }
+    }
+    os << std::endl;
+
+    os << std::setprecision(6);
+    for (const Result& result: results) {
+      os << '"' << result.name << '"';
+      for (const auto& [key, value]: result.labels) {
+        os << ',' << value;
+      }
+      os << ',' << result.values << ',' << result.repetitions << ',' << result.ns_per_value
+         << ',' << result.min_ns_per_value << ',' << result.values_per_second() << ','
+         << result.bytes_per_second();
+      for (const auto& [name, value]: result.metrics) {
+        os << ',' << value;
+      }
+      os << std::endl;
+    }
+  }
+
+  void ReportJSON(const std::vector<Result>& results, std::ostream& os) const {
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    os << "{" << std::endl
+       << "  \"context\": {" << std::endl
+       << "    \"date\": \"" << date << "\"," << std::endl
+       << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl
+       << "    \"min_time\": " << options_.min_time << "," << std::endl
+       << "    \"repetitions\": " << options_.repetitions << "," << std::endl
+       << "    \"latency\": " << (options_.latency ? "true" : "false") << "," << std::endl
+       << "    \"timer_overhead_ns\": " << timer_ns_ << "," << std::endl
+       << "    \"calibration_ns\": " << calibration_ns_ << std::endl
+       << "  }," << std::endl;
+    if (!options_.tolerances.empty()) {
+      os << "  \"tolerances\": {";
+      for (std::size_t i = 0; i < options_.tolerances.size(); ++i) {
+        os << (i == 0 ? "" : ",") << std::endl << "    \"" << Escape(options_.tolerances[i].first)
+           << "\": " << options_.tolerances[i].second;
+      }
+      os << std::endl << "  }," << std::endl;
+    }
+    os << "  \"benchmarks\": [";
+
+    os << std::setprecision(6);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      const Result& result = results[i];
+      os << (i == 0 ? "" : ",") << std::endl
+         << "    {" << std::endl
+         << "      \"name\": \"" << Escape(result.name) << "\"," << std::endl;
+      for (const auto& [key, value]: result.labels) {
+        os << "      \"" << Escape(key) << "\": \"" << Escape(value) << "\"," << std::endl;
+      }
+      os << "      \"values\": " << result.values << "," << std::endl
+         << "      \"repetitions\": " << result.repetitions << "," << std::endl
+         << "      \"ns_per_value\": " << result.ns_per_value << "," << std::endl
+         << "      \"min_ns_per_value\": " << result.min_ns_per_value << "," << std::endl
+         << "      \"values_per_second\": " << result.values_per_second() << "," << std::endl
+         << "      \"bytes_per_second\": " << result.bytes_per_second();
+      for (const auto& [name, value]: result.metrics) {
+        os << "," << std::endl << "      \"" << Escape(name) << "\": " << value;
+      }
+      os << std::endl << "    }";
+    }
+    os << std::endl << "  ]" << std::endl << "}" << std::endl;
+  }
+
+  Options options_;
+  std::vector<Benchmark> benchmarks_;
+  std::unique_ptr<PerfCounters> counters_;
+  // Median time of reading the timer twice in latency mode
+  double timer_ns_ = 0.0;
+  double calibration_ns_ = 0.0;
+};
+
+} // namespace bench
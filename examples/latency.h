@@ -0,0 +1,127 @@
+/// Per-call latency measurement for the benchmark harness. `Ticks` reads the
+/// time stamp counter on x86-64 (serialized with `lfence`) and steady_clock
+/// nanoseconds elsewhere. `LatencyHistogram` records tick counts in log-linear
+/// buckets in the style of HdrHistogram: values below 2^precision are exact,
+/// and larger values keep `precision` significant bits, so a percentile is
+/// within a relative error of 2^-precision with a fixed memory footprint.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define BENCH_HAS_RDTSC 1
+#endif
+
+namespace bench {
+
+struct Ticks {
+  // Returns the current tick count
+  static std::uint64_t Now() {
+#ifdef BENCH_HAS_RDTSC
+    _mm_lfence();
+    const std::uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  // Returns the duration of a tick in nanoseconds, calibrated once against
+  // steady_clock for the time stamp counter
+  static double Nanoseconds() {
+#ifdef BENCH_HAS_RDTSC
+    static const double nanoseconds = [] {
+      using clock = std::chrono::steady_clock;
+      const clock::time_point start = clock::now();
+      const std::uint64_t first = Now();
+      while (clock::now() - start < std::chrono::milliseconds(20)) {}
+      const std::uint64_t last = Now();
+      const double elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+      return elapsed / double(last - first);
+    }();
+    return nanoseconds;
+#else
+    return 1.0;
+#endif
+  }
+};
+
+class LatencyHistogram {
+ public:
+  explicit LatencyHistogram(unsigned precision = 7)
+      : precision_(precision),
+        counts_((std::size_t(64 - precision_) + 1) << precision_, 0) {}
+
+  void Record(std::uint64_t value) {
+    counts_[Index(value)]++;
+    count_++;
+    sum_ += double(value);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  std::uint64_t count() const { return count_; }
+  std::uint64_t min() const { return count_ == 0 ? 0 : min_; }
+  std::uint64_t max() const { return max_; }
+  double mean() const { return count_ == 0 ? 0.0 : sum_ / double(count_); }
+
+  // Returns the smallest recorded value (to the precision of the buckets) that
+  // is at least the given percentage of the values
+  std::uint64_t Percentile(double percent) const {
+    const std::uint64_t rank = std::max<std::uint64_t>(
+        1, std::uint64_t(std::ceil(percent / 100.0 * double(count_))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min(Highest(i), max_);
+      }
+    }
+    return max_;
+  }
+ private:
+  // Returns the position of the highest set bit
+  static unsigned Log2(std::uint64_t value) {
+    unsigned log = 0;
+    while (value >>= 1) {
+      log++;
+    }
+    return log;
+  }
+
+  std::size_t Index(std::uint64_t value) const {
+    if (value >> precision_ == 0) {
+      return std::size_t(value);
+    }
+    const unsigned shift = Log2(value) - precision_;
+    return (std::size_t(shift + 1) << precision_) +
+           std::size_t((value >> shift) - (std::uint64_t(1) << precision_));
+  }
+
+  // Returns the highest value of the bucket at the given index
+  std::uint64_t Highest(std::size_t index) const {
+    if (index >> precision_ == 0) {
+      return index;
+    }
+    const unsigned shift = unsigned(index >> precision_) - 1;
+    const std::uint64_t sub = index & ((std::size_t(1) << precision_) - 1);
+    return (((std::uint64_t(1) << precision_) + sub + 1) << shift) - 1;
+  }
+
+  unsigned precision_;
+  std::vector<std::uint64_t> counts_;
+  std::uint64_t count_ = 0;
+  double sum_ = 0.0;
+  std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max(), max_ = 0;
+};
+
+} // namespace bench
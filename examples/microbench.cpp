@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "baseline.h"
+#include "harness.h"
+#include "hash.h"
+#include "mersenne.h"
+#include "pcg.h"
+#include "polar.h"
+#include "reverse.h"
+#include "xoshiro.h"
+
+using namespace reverse;
+
+static const char* USAGE = R"(Usage: microbench [options]
+
+Benchmarks every engine and distribution of the reversible generators with
+scalar next()/previous() and batch next(N)/previous(N) calls.
+
+Options:
+  --batches N,...   batch sizes in values, 1 for scalar calls (default:
+                    1,256,4096,32768,262144,4194304 i.e. L1 to DRAM)
+  --threads T       generate batches with T threads (default: 1)
+  --filter TEXT     only run benchmarks whose name contains TEXT (or one of
+                    its alternatives separated by '|')
+  --min-time S      minimum time of a repetition in seconds (default: 0.1)
+  --repetitions R   repetitions of each benchmark (default: 3)
+  --format F        console (default), csv or json
+  --counters        report hardware performance counters per value (Linux)
+  --latency         time every call and report the p50, p99, p99.9 and
+                    maximum latency of calls
+  --output FILE     write the results to FILE instead of stdout
+  --gate            run the short subset of the regression gate
+  --check FILE      compare the results to the baseline (a JSON report) in
+                    FILE and exit with a failure if a metric regressed
+  --tolerance M=X   relative tolerance X of metric M written with JSON
+                    reports e.g. min_ns_per_value=0.25 (repeatable)
+  --seed S          seed of the generators (default: 42)
+  --help            print this message
+)";
+
+// Short and stable subset of the benchmarks for the regression gate, which
+// covers the common distributions in both directions
+static const char* GATE_FILTER =
+    "PCG64/uniform<int>/|PCG64/uniform<double>/|PCG64/normal<double>/|"
+    "PCG64/exponential<double>/|Mersenne/normal<double>/";
+
+struct Config {
+  std::vector<std::size_t> batches = {1, 256, 4096, 32768, 262144, 4194304};
+  unsigned threads = 1;
+  std::uint64_t seed = 42;
+};
+
+template <typename URNG, typename = void>
+struct is_reversible : std::false_type {};
+
+template <typename URNG>
+struct is_reversible<URNG, std::void_t<decltype(std::declval<URNG&>().previous())>>
+    : std::true_type {};
+
+template <typename RRNG, typename = void>
+struct has_batch : std::false_type {};
+
+template <typename RRNG>
+struct has_batch<RRNG, std::void_t<decltype(std::declval<RRNG&>().next(std::size_t(1)))>>
+    : std::true_type {};
+
+// Returns the next value of the generator, or the previous value if reversible
+// and not `forward`
+template <bool Reversible, typename RRNG>
+static auto Scalar(RRNG& rng, bool forward) {
+  if constexpr (Reversible) {
+    return forward ? rng.next() : rng.previous();
+  } else {
+    return rng.next();
+  }
+}
+
+// Returns a vector of the next or previous `N` values of the generator (see
+// `Scalar`)
+template <bool Reversible, typename RRNG>
+static auto Batch(RRNG& rng, std::size_t N, bool forward, unsigned threads) {
+  if constexpr (!has_batch<RRNG>::value) {
+    std::vector<decltype(rng.next())> values(N);
+    for (auto& value: values) {
+      value = Scalar<Reversible>(rng, forward);
+    }
+    return values;
+  } else if constexpr (Reversible) {
+    if (threads > 1) {
+      return forward ? rng.next(N, Parallel{threads}) : rng.previous(N, Parallel{threads});
+    }
+    return forward ? rng.next(N) : rng.previous(N);
+  } else {
+    // Parallel generation seeks the engine backwards
+    (void)threads;
+    return rng.next(N);
+  }
+}
+
+/// Adds the benchmarks of a generator for both directions (if reversible) and
+/// every batch size. `make` constructs a seeded generator.
+template <typename RRNG, bool Reversible, typename Make>
+static void AddGenerator(bench::Harness& harness, const Config& config,
+                         const std::string& engine, const std::string& distribution,
+                         Make make) {
+  using result_type = decltype(std::declval<RRNG&>().next());
+
+  for (const bool forward: {true, false}) {
+    if (!forward && !Reversible) {
+      continue;
+    }
+    const std::string direction = forward ? "next" : "previous";
+
+    for (const std::size_t batch: config.batches) {
+      const std::string call = batch == 1 ? "scalar" : config.threads > 1 ? "parallel" : "batch";
+      bench::Benchmark benchmark;
+      benchmark.name = engine + "/" + distribution + "/" + direction + "/" + std::to_string(batch);
+      benchmark.labels = {{"engine", engine}, {"distribution", distribution},
+                          {"direction", direction}, {"call", call},
+                          {"batch", std::to_string(batch)},
+                          {"threads", std::to_string(batch == 1 ? 1 : config.threads)}};
+      benchmark.value_bytes = sizeof(result_type);
+
+      // Shared since the benchmark function is copyable
+      const std::shared_ptr<RRNG> rng = make();
+      const unsigned threads = config.threads;
+      if (batch == 1) {
+        benchmark.run = [rng, forward](std::uint64_t values) {
+          for (std::uint64_t i = 0; i < values; ++i) {
+            bench::DoNotOptimize(Scalar<Reversible>(*rng, forward));
+          }
+          return values;
+        };
+        benchmark.sample = [rng, forward](std::uint64_t calls, bench::LatencyHistogram& histogram) {
+          for (std::uint64_t i = 0; i < calls; ++i) {
+            const std::uint64_t start = bench::Ticks::Now();
+            bench::DoNotOptimize(Scalar<Reversible>(*rng, forward));
+            histogram.Record(bench::Ticks::Now() - start);
+          }
+          return calls;
+        };
+      } else {
+        benchmark.run = [rng, forward, batch, threads](std::uint64_t values) {
+          const std::uint64_t calls = (values + batch - 1) / batch;
+          for (std::uint64_t i = 0; i < calls; ++i) {
+            const auto batch_values = Batch<Reversible>(*rng, batch, forward, threads);
+            bench::DoNotOptimize(batch_values.data());
+            bench::ClobberMemory();
+          }
+          return calls * batch;
+        };
+        benchmark.sample = [rng, forward, batch, threads](std::uint64_t calls,
+                                                          bench::LatencyHistogram& histogram) {
+          for (std::uint64_t i = 0; i < calls; ++i) {
+            const std::uint64_t start = bench::Ticks::Now();
+            const auto batch_values = Batch<Reversible>(*rng, batch, forward, threads);
+            bench::DoNotOptimize(batch_values.data());
+            bench::ClobberMemory();
+            histogram.Record(bench::Ticks::Now() - start);
+          }
+          return calls * batch;
+        };
+      }
+      harness.Add(std::move(benchmark));
+    }
+  }
+}
+
+template <typename DistType, typename EngineType>
+static void AddDistribution(bench::Harness& harness, const Config& config,
+                            const std::string& engine, const std::string& distribution) {
+  using RNG = ReversibleRNG<DistType, EngineType>;
+  const std::uint64_t seed = config.seed;
+  // Buffered distributions read engine draws backwards
+  if constexpr (RNG::block_size == 1 || is_reversible<EngineType>::value) {
+    AddGenerator<RNG, is_reversible<EngineType>::value>(harness, config, engine, distribution,
+        [seed] { return std::make_shared<RNG>(Seed{seed}); });
+  }
+}
+
+// Adds every distribution on the given engine. Integer, normal, exponential
+// and blocked values require a 64-bit engine.
+template <typename EngineType>
+static void AddEngine(bench::Harness& harness, const Config& config, const std::string& engine) {
+  constexpr bool is_64_bit =
+      util::range<EngineType>() == std::numeric_limits<std::uint64_t>::max();
+  if constexpr (is_64_bit) {
+    AddDistribution<UniformDistribution<std::uint64_t>, EngineType>(
+        harness, config, engine, "uniform<uint64>");
+    AddDistribution<UniformDistribution<int>, EngineType>(harness, config, engine, "uniform<int>");
+  }
+  AddDistribution<UniformDistribution<double>, EngineType>(
+      harness, config, engine, "uniform<double>");
+  AddDistribution<UniformDistribution<float>, EngineType>(
+      harness, config, engine, "uniform<float>");
+  if constexpr (is_64_bit) {
+    AddDistribution<Blocked<UniformDistribution<float>>, EngineType>(
+        harness, config, engine, "blocked<uniform<float>>");
+    AddDistribution<NormalDistribution<double>, EngineType>(
+        harness, config, engine, "normal<double>");
+    AddDistribution<NormalDistribution<float>, EngineType>(
+        harness, config, engine, "normal<float>");
+    AddDistribution<ExponentialDistribution<double>, EngineType>(
+        harness, config, engine, "exponential<double>");
+    AddDistribution<ExponentialDistribution<float>, EngineType>(
+        harness, config, engine, "exponential<float>");
+  }
+}
+
+static std::vector<std::size_t> ParseBatches(const std::string& text) {
+  std::vector<std::size_t> batches;
+  std::size_t begin = 0;
+  while (begin <= text.size()) {
+    const std::size_t end = std::min(text.find(',', begin), text.size());
+    batches.push_back(std::stoull(text.substr(begin, end - begin)));
+    if (batches.back() == 0) {
+      throw std::invalid_argument("Batch sizes must be positive.");
+    }
+    begin = end + 1;
+  }
+  return batches;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    Config config;
+    bench::Options options;
+    std::string output, check;
+    int tolerance_args = 0;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 == argc) {
+          throw std::invalid_argument("Missing value of " + arg + ".");
+        }
+        return argv[++i];
+      };
+
+      if (arg == "--batches") {
+        config.batches = ParseBatches(value());
+      } else if (arg == "--threads") {
+        config.threads = std::stoul(value());
+      } else if (arg == "--filter") {
+        options.filter = value();
+      } else if (arg == "--min-time") {
+        options.min_time = std::stod(value());
+      } else if (arg == "--repetitions") {
+        options.repetitions = std::stoul(value());
+      } else if (arg == "--format") {
+        options.format = value();
+      } else if (arg == "--latency") {
+        options.latency = true;
+      } else if (arg == "--counters") {
+        options.counters = true;
+      } else if (arg == "--output") {
+        output = value();
+      } else if (arg == "--gate") {
+        config.batches = {1, 4096};
+        options.filter = GATE_FILTER;
+        options.min_time = 0.05;
+        options.repetitions = 5;
+        if (options.tolerances.empty()) {
+          options.tolerances = {{"min_ns_per_value", 0.25}, {"ns_per_value", 0.4}};
+        }
+      } else if (arg == "--check") {
+        check = value();
+      } else if (arg == "--tolerance") {
+        const std::string tolerance = value();
+        const std::size_t equals = tolerance.find('=');
+        if (equals == std::string::npos) {
+          throw std::invalid_argument("Tolerance must be METRIC=VALUE.");
+        }
+        if (tolerance_args++ == 0) {
+          options.tolerances.clear();
+        }
+        options.tolerances.emplace_back(tolerance.substr(0, equals),
+                                        std::stod(tolerance.substr(equals + 1)));
+      } else if (arg == "--seed") {
+        config.seed = std::stoull(value(), nullptr, 0);
+      } else if (arg == "--help") {
+        std::cout << USAGE;
+        return EXIT_SUCCESS;
+      } else {
+        throw std::invalid_argument("Unknown option " + arg + ".");
+      }
+    }
+
+    bench::Harness harness(options);
+    AddEngine<ReversiblePCG<pcg64>>(harness, config, "PCG64");
+    AddEngine<ReversiblePCG<pcg32>>(harness, config, "PCG32");
+    AddEngine<ReversibleMersenne>(harness, config, "Mersenne");
+    AddEngine<Xoshiro256>(harness, config, "Xoshiro256"); // Forward only
+    AddEngine<ReversibleHash>(harness, config, "Hash");
+
+    // The polar method is a generator of its own on a uniform PCG64 generator
+    const std::uint64_t seed = config.seed;
+    AddGenerator<ReversiblePolar<>, true>(harness, config, "PCG64", "polar<double>", [seed] {
+      auto rng = std::make_shared<ReversiblePolar<>>();
+      rng->seed(seed);
+      return rng;
+    });
+
+    if (!check.empty()) {
+      const bench::Baseline baseline(check);
+      return baseline.Check(harness, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const std::vector<bench::Result> results = harness.Run();
+    if (output.empty()) {
+      harness.Report(results, std::cout);
+    } else {
+      std::ofstream file(output);
+      harness.Report(results, file);
+      if (!file) {
+        throw std::runtime_error("Cannot write " + output + ".");
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "microbench: " << e.what() << std::endl << USAGE;
+    return EXIT_FAILURE;
+  }
+}
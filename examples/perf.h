@@ -0,0 +1,138 @@
+/// Hardware performance counters of the calling thread (and the threads it
+/// creates while counting) with the Linux `perf_event_open` system call. Every
+/// counter is opened on its own, so unsupported events (e.g. in a virtual
+/// machine) are skipped, and no counters are available on other platforms or
+/// if access is denied (see /proc/sys/kernel/perf_event_paranoid). Counts are
+/// scaled when the kernel multiplexes more events than hardware counters.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+class PerfCounters {
+ public:
+  PerfCounters() {
+#ifdef __linux__
+    constexpr std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    constexpr std::uint64_t llc_read_miss = PERF_COUNT_HW_CACHE_LL |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    Open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    Open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    Open("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    Open("l1d_misses", PERF_TYPE_HW_CACHE, l1d_read_miss);
+    Open("llc_misses", PERF_TYPE_HW_CACHE, llc_read_miss);
+#else
+    error_ = "performance counters require Linux";
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (const Counter& counter: counters_) {
+      close(counter.fd);
+    }
+#endif
+  }
+
+  // Returns whether any counter is available
+  bool available() const { return !counters_.empty(); }
+
+  // Returns why no counter is available
+  const std::string& error() const { return error_; }
+
+  // Returns the names of the available counters
+  std::vector<std::string> names() const {
+    std::vector<std::string> names;
+    for (const Counter& counter: counters_) {
+      names.push_back(counter.name);
+    }
+    return names;
+  }
+
+  // Resets and starts the counters
+  void Start() {
+#ifdef __linux__
+    for (const Counter& counter: counters_) {
+      ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+    }
+    for (const Counter& counter: counters_) {
+      ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Stops the counters and returns their (scaled) counts in the order of
+  // `names`
+  std::vector<double> Stop() {
+    std::vector<double> counts;
+#ifdef __linux__
+    for (const Counter& counter: counters_) {
+      ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (const Counter& counter: counters_) {
+      // Value, time enabled and time running (see read_format)
+      std::uint64_t values[3] = {};
+      double count = 0;
+      if (read(counter.fd, values, sizeof(values)) == sizeof(values) && values[2] != 0) {
+        count = double(values[0]) * double(values[1]) / double(values[2]);
+      }
+      counts.push_back(count);
+    }
+#endif
+    return counts;
+  }
+ private:
+  struct Counter {
+    std::string name;
+    int fd;
+  };
+
+#ifdef __linux__
+  void Open(const std::string& name, std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1; // Threads of parallel batches
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0) {
+      if (error_.empty()) {
+        error_ = name + ": " + std::strerror(errno);
+      }
+      return;
+    }
+    counters_.push_back({name, int(fd)});
+  }
+#endif
+
+  std::vector<Counter> counters_;
+  std::string error_;
+};
+
+} // namespace bench
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "reverse.h"
+
+using namespace reverse;
+
+// Number of values generated at a time
+constexpr std::size_t BLOCK = 1 << 20;
+
+// Size of the output buffer in bytes
+constexpr std::size_t BUFFER = 1 << 22;
+
+static const char* USAGE = R"(Usage: reverse-gen [options]
+
+Streams random values of a reversible generator to stdout (or a file) in
+either direction, e.g. `reverse-gen --dist bits | RNG_test stdin64`.
+
+Options:
+  --dist NAME      bits (default, raw 64-bit engine output), uniform, int,
+                   normal or exponential
+  --params A[,B]   distribution parameters: uniform [a, b), int [a, b],
+                   normal mean and standard deviation, exponential lambda
+  --seed S         seed of the generator (default: std::random_device)
+  --start P        position of the first value (default: 0)
+  --count N        number of values, 0 for an infinite stream (default: 0)
+  --backward       generate the values before the start position, in
+                   reverse order
+  --threads T      generate blocks with T threads (default: 1)
+  --csv            write one value per line as text (default: binary values
+                   in the byte order of the host)
+  --output FILE    write to FILE instead of stdout
+  --help           print this message
+)";
+
+struct Options {
+  std::string dist = "bits";
+  std::vector<double> params;
+  bool seeded = false;
+  std::uint64_t seed = 0;
+  std::int64_t start = 0;
+  std::uint64_t count = 0;
+  bool backward = false;
+  unsigned threads = 1;
+  bool csv = false;
+  std::string output;
+};
+
+static std::vector<double> ParseParams(const std::string& text) {
+  std::vector<double> params;
+  std::size_t begin = 0;
+  while (begin <= text.size()) {
+    const std::size_t end = std::min(text.find(',', begin), text.size());
+    params.push_back(std::stod(text.substr(begin, end - begin)));
+    begin = end + 1;
+  }
+  return params;
+}
+
+static Options ParseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 == argc) {
+        throw std::invalid_argument("Missing value of " + arg + ".");
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--dist") {
+      options.dist = value();
+    } else if (arg == "--params") {
+      options.params = ParseParams(value());
+    } else if (arg == "--seed") {
+      options.seeded = true;
+      options.seed = std::stoull(value(), nullptr, 0);
+    } else if (arg == "--start") {
+      options.start = std::stoll(value());
+    } else if (arg == "--count") {
+      options.count = std::stoull(value());
+    } else if (arg == "--backward") {
+      options.backward = true;
+    } else if (arg == "--threads") {
+      options.threads = std::stoul(value());
+    } else if (arg == "--csv") {
+      options.csv = true;
+    } else if (arg == "--output") {
+      options.output = value();
+    } else if (arg == "--help") {
+      std::cout << USAGE;
+      std::exit(EXIT_SUCCESS);
+    } else {
+      throw std::invalid_argument("Unknown option " + arg + ".");
+    }
+  }
+  return options;
+}
+
+// Returns the distribution parameter at `i`, or the default if not given
+static double Param(const Options& options, std::size_t i, double fallback) {
+  return i < options.params.size() ? options.params[i] : fallback;
+}
+
+// Checks the number and range of the distribution parameters, which the
+// distributions only assert
+static void CheckParams(const Options& options) {
+  const std::string& dist = options.dist;
+  const std::size_t count = dist == "bits" ? 0 : dist == "exponential" ? 1 : 2;
+  if (options.params.size() > count) {
+    throw std::invalid_argument("Distribution " + dist + " takes " +
+        (count == 0 ? "no parameters." : count == 1 ? "one parameter." : "two parameters."));
+  }
+  for (const double param: options.params) {
+    if (!std::isfinite(param)) {
+      throw std::invalid_argument("Distribution parameters must be finite.");
+    }
+  }
+
+  if (dist == "uniform" && Param(options, 0, 0.0) > Param(options, 1, 1.0)) {
+    throw std::invalid_argument("Uniform requires a <= b.");
+  } else if (dist == "int") {
+    // Limits of std::int64_t that are exact doubles: [-2^63, 2^63)
+    constexpr double limit = 9223372036854775808.0;
+    const double a = Param(options, 0, 0.0);
+    const double b = Param(options, 1, double(std::numeric_limits<std::int32_t>::max()));
+    if (a != std::trunc(a) || b != std::trunc(b) || a < -limit || b >= limit) {
+      throw std::invalid_argument("Int requires 64-bit integer bounds.");
+    }
+    if (a > b) {
+      throw std::invalid_argument("Int requires a <= b.");
+    }
+  } else if (dist == "normal" && !(Param(options, 1, 1.0) > 0.0)) {
+    throw std::invalid_argument("Normal requires a positive standard deviation.");
+  } else if (dist == "exponential" && !(Param(options, 0, 1.0) > 0.0)) {
+    throw std::invalid_argument("Exponential requires a positive lambda.");
+  }
+}
+
+// Returns the error of a failed write
+static std::system_error WriteError() {
+  return std::system_error(errno, std::generic_category(), "Cannot write the values");
+}
+
+template <typename T>
+static void WriteCSV(const std::vector<T>& values, std::FILE* out) {
+  for (const T value: values) {
+    if constexpr (std::is_floating_point<T>::value) {
+      std::fprintf(out, "%.17g\n", double(value));
+    } else if constexpr (std::is_signed<T>::value) {
+      std::fprintf(out, "%" PRId64 "\n", std::int64_t(value));
+    } else {
+      std::fprintf(out, "%" PRIu64 "\n", std::uint64_t(value));
+    }
+  }
+}
+
+/// Writes `count` values (infinitely many if zero) after or before the start
+/// position. Values are generated in blocks of BLOCK values with the vector
+/// functions of the generator, and written with a single call per block.
+template <typename RRNG>
+static void Generate(RRNG& rng, const Options& options, std::FILE* out) {
+  rng.seek(options.start);
+
+  const Parallel policy{options.threads};
+  for (std::uint64_t written = 0; options.count == 0 || written < options.count;) {
+    const std::size_t size = options.count == 0
+        ? BLOCK : std::size_t(std::min<std::uint64_t>(BLOCK, options.count - written));
+
+    auto values = options.backward ? rng.previous(size, policy) : rng.next(size, policy);
+    if (options.backward) {
+      std::reverse(values.begin(), values.end()); // Order of generation
+    }
+
+    if (options.csv) {
+      WriteCSV(values, out);
+    } else {
+      std::fwrite(values.data(), sizeof(values[0]), values.size(), out);
+    }
+    if (std::ferror(out)) {
+      throw WriteError();
+    }
+    written += size;
+  }
+}
+
+template <typename RRNG, typename... Args>
+static void Run(const Options& options, std::FILE* out, Args&&... args) {
+  RRNG rng(defer_seed, std::forward<Args>(args)...);
+  if (options.seeded) {
+    rng.seed(options.seed);
+  } else {
+    pcg_extras::seed_seq_from<std::random_device> seed_source;
+    rng.seed(seed_source);
+  }
+  Generate(rng, options, out);
+}
+
+int main(int argc, char* argv[]) {
+#ifdef SIGPIPE
+  // Writes to a closed pipe fail with EPIPE instead of killing the process
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+  try {
+    const Options options = ParseOptions(argc, argv);
+    CheckParams(options);
+
+    std::FILE* out = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "wb");
+    if (out == nullptr) {
+      throw std::runtime_error("Cannot open " + options.output + ".");
+    }
+    std::setvbuf(out, nullptr, _IOFBF, BUFFER);
+
+    if (options.dist == "bits") {
+      Run<UniformRNG<std::uint64_t>>(options, out);
+    } else if (options.dist == "uniform") {
+      Run<UniformRNG<double>>(options, out, Param(options, 0, 0.0), Param(options, 1, 1.0));
+    } else if (options.dist == "int") {
+      Run<UniformRNG<std::int64_t>>(options, out, std::int64_t(Param(options, 0, 0.0)),
+          std::int64_t(Param(options, 1, double(std::numeric_limits<std::int32_t>::max()))));
+    } else if (options.dist == "normal") {
+      Run<NormalRNG<double>>(options, out, Param(options, 0, 0.0), Param(options, 1, 1.0));
+    } else if (options.dist == "exponential") {
+      Run<ExponentialRNG<double>>(options, out, Param(options, 0, 1.0));
+    } else {
+      throw std::invalid_argument("Unknown distribution " + options.dist + ".");
+    }
+
+    if (std::fclose(out) != 0) {
+      throw WriteError();
+    }
+  } catch (const std::system_error& e) {
+    // A closed pipe ends the stream, e.g. of `reverse-gen | head`
+    if (e.code() == std::errc::broken_pipe) {
+      return EXIT_SUCCESS;
+    }
+    std::cerr << "reverse-gen: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  } catch (const std::exception& e) {
+    std::cerr << "reverse-gen: " << e.what() << std::endl << USAGE;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event.h"
+#include "harness.h"
+#include "mersenne.h"
+#include "pcg.h"
+#include "reverse.h"
+
+using namespace reverse;
+
+static const char* USAGE = R"(Usage: rollback [options]
+
+Benchmarks rollback strategies of an optimistic simulation: events draw random
+values, and random rollbacks undo the most recent events, which are then
+executed again. Reports the time per event (including rollbacks and
+re-execution) and the peak memory of the rollback history of each strategy:
+
+  previous    steps back with previous() over the values of each event
+  jump        event marks and rollback() i.e. seek, which jumps the engine for
+              distributions with a fixed number of draws per value
+  copy        copies the generator at the start of every event
+  checkpoint  copies the generator every --interval events and replays the
+              values from the nearest checkpoint
+
+Saved generators count with the size of their binary form (binary_size).
+
+Options:
+  --depths D,...          maximum rollback depths in events, uniformly
+                          distributed from 1 (default: 1,10,100,1000)
+  --event-size N          mean number of values per event, uniformly
+                          distributed in [1, 2N - 1] (default: 8)
+  --rollback-fraction F   rolled back events per event, which sets the
+                          probability of a rollback before an event to F
+                          divided by the mean depth (default: 0.1)
+  --window W              events kept for rollback after a commit, at least
+                          the maximum depth (default: 4096)
+  --interval K            events between checkpoints (default: 16)
+  --filter TEXT           only run benchmarks whose name contains TEXT (or one
+                          of its alternatives separated by '|')
+  --min-time S            minimum time of a repetition in seconds (default: 0.1)
+  --repetitions R         repetitions of each benchmark (default: 3)
+  --format F              console (default), csv or json
+  --output FILE           write the results to FILE instead of stdout
+  --help                  print this message
+)";
+
+struct Workload {
+  std::uint32_t event_size = 8;
+  double rollback_fraction = 0.1;
+  std::uint32_t depth = 0;
+  std::size_t window = 4096;
+  std::size_t interval = 16;
+};
+
+// Draws the values of an event and returns their sum
+template <typename RNG>
+static double Draw(RNG& rng, std::uint32_t size) {
+  double sum = 0.0;
+  for (std::uint32_t i = 0; i < size; ++i) {
+    sum += double(rng.next());
+  }
+  return sum;
+}
+
+/// Steps back over the values of the rolled back events. The history is the
+/// number of values of every event.
+template <typename RNG>
+class Previous {
+ public:
+  explicit Previous(const RNG& rng) : rng_(rng) {}
+
+  double Event(std::uint32_t size) {
+    sizes_.push_back(size);
+    return Draw(rng_, size);
+  }
+
+  void Rollback(std::size_t events) {
+    for (; events != 0; --events) {
+      for (std::uint32_t i = 0; i < sizes_.back(); ++i) {
+        rng_.previous();
+      }
+      sizes_.pop_back();
+    }
+  }
+
+  // Keeps the given number of most recent events
+  void Commit(std::size_t keep) { sizes_.erase(sizes_.begin(), sizes_.end() - keep); }
+
+  std::size_t bytes() const { return sizes_.size() * sizeof(std::uint32_t); }
+ private:
+  RNG rng_;
+  std::vector<std::uint32_t> sizes_;
+};
+
+/// Marks every event and rolls back with `EventRNG::rollback`, which
+/// seeks to the position of the mark. The history is the marks.
+template <typename RNG>
+class Jump {
+ public:
+  explicit Jump(const RNG& rng) : rng_(rng) {}
+
+  double Event(std::uint32_t size) {
+    rng_.mark();
+    return Draw(rng_, size);
+  }
+
+  void Rollback(std::size_t events) { rng_.rollback(events); }
+
+  void Commit(std::size_t keep) { rng_.commit(rng_.events() - keep); }
+
+  std::size_t bytes() const { return rng_.events() * sizeof(std::int64_t); }
+ private:
+  EventRNG<RNG> rng_;
+};
+
+/// Copies the generator at the start of every event and restores the copy of
+/// the earliest rolled back event. The history is the copies, which count
+/// with the size of their binary form (the state that a copy must save).
+template <typename RNG>
+class Copy {
+ public:
+  explicit Copy(const RNG& rng) : rng_(rng) {}
+
+  double Event(std::uint32_t size) {
+    copies_.push_back(rng_);
+    return Draw(rng_, size);
+  }
+
+  void Rollback(std::size_t events) {
+    rng_ = copies_[copies_.size() - events];
+    copies_.resize(copies_.size() - events);
+  }
+
+  void Commit(std::size_t keep) { copies_.erase(copies_.begin(), copies_.end() - keep); }
+
+  std::size_t bytes() const { return copies_.size() * RNG::binary_size; }
+ private:
+  RNG rng_;
+  std::vector<RNG> copies_;
+};
+
+/// Copies the generator at the start of every `interval` events. A rollback
+/// restores the nearest checkpoint before the rolled back events and replays
+/// (discards) the values of the events in between. The history is the
+/// checkpoints (in binary form, see Copy) and the number of values of every
+/// event.
+template <typename RNG>
+class Checkpoint {
+ public:
+  Checkpoint(const RNG& rng, std::size_t interval) : rng_(rng), interval_(interval) {}
+
+  double Event(std::uint32_t size) {
+    if ((first_ + sizes_.size()) % interval_ == 0) {
+      checkpoints_.push_back(rng_);
+    }
+    sizes_.push_back(size);
+    return Draw(rng_, size);
+  }
+
+  void Rollback(std::size_t events) {
+    // Restores the nearest checkpoint at or before the earliest rolled back
+    // event, and drops the later checkpoints
+    const std::uint64_t event = first_ + sizes_.size() - events;
+    const std::uint64_t checkpoint = event / interval_ * interval_;
+    checkpoints_.resize(checkpoint / interval_ - Checkpointed() + 1);
+    rng_ = checkpoints_.back();
+
+    std::uint64_t values = 0;
+    for (std::uint64_t e = checkpoint; e < event; ++e) {
+      values += sizes_[e - first_];
+    }
+    rng_.discard(values);
+
+    sizes_.resize(sizes_.size() - events);
+    if (checkpoint == event) {
+      checkpoints_.pop_back(); // Recorded again by the next event
+    }
+  }
+
+  // Keeps the given number of most recent events and their nearest checkpoint
+  void Commit(std::size_t keep) {
+    const std::uint64_t event = first_ + sizes_.size() - keep;
+    const std::uint64_t checkpoint = event / interval_ * interval_;
+    checkpoints_.erase(checkpoints_.begin(),
+                       checkpoints_.begin() + (checkpoint / interval_ - Checkpointed()));
+    sizes_.erase(sizes_.begin(), sizes_.begin() + (checkpoint - first_));
+    first_ = checkpoint;
+  }
+
+  std::size_t bytes() const {
+    return checkpoints_.size() * RNG::binary_size + sizes_.size() * sizeof(std::uint32_t);
+  }
+ private:
+  // Returns the index of the first kept checkpoint
+  std::uint64_t Checkpointed() const { return first_ / interval_; }
+
+  RNG rng_;
+  std::size_t interval_;
+  std::vector<RNG> checkpoints_;
+  std::vector<std::uint32_t> sizes_;
+  // Index of the first kept event, which has a checkpoint
+  std::uint64_t first_ = 0;
+};
+
+/// Optimistic simulation of events with random sizes and random rollbacks,
+/// which are identical for every strategy. When the history reaches twice the
+/// window, the events before the window are committed.
+template <typename Strategy>
+class Simulation {
+ public:
+  Simulation(Strategy strategy, const Workload& workload)
+      : strategy_(std::move(strategy)), workload_(workload) {}
+
+  // Processes the given number of events (and the rollbacks before them)
+  void Run(std::uint64_t events) {
+    std::uniform_int_distribution<std::uint32_t> size(1, 2 * workload_.event_size - 1);
+    std::uniform_int_distribution<std::uint32_t> depth(1, workload_.depth);
+    std::bernoulli_distribution rollback(
+        std::min(1.0, 2 * workload_.rollback_fraction / (1.0 + workload_.depth)));
+
+    for (std::uint64_t i = 0; i < events; ++i) {
+      if (history_ != 0 && rollback(workload_rng_)) {
+        const std::size_t events = std::min<std::size_t>(depth(workload_rng_), history_);
+        strategy_.Rollback(events);
+        history_ -= events;
+      }
+
+      checksum_ += strategy_.Event(size(workload_rng_));
+      history_++;
+      peak_bytes_ = std::max(peak_bytes_, strategy_.bytes());
+      if (history_ == 2 * workload_.window) {
+        strategy_.Commit(workload_.window);
+        history_ = workload_.window;
+      }
+    }
+  }
+
+  // Sum of the values of all (also rolled back) events
+  double checksum() const { return checksum_; }
+
+  // Peak memory of the rollback history in bytes
+  std::size_t peak_bytes() const { return peak_bytes_; }
+ private:
+  Strategy strategy_;
+  Workload workload_;
+  std::mt19937_64 workload_rng_;
+  std::size_t history_ = 0;
+  double checksum_ = 0.0;
+  std::size_t peak_bytes_ = 0;
+};
+
+template <typename Strategy>
+static void AddStrategy(bench::Harness& harness, const bench::Labels& labels,
+                        const std::string& name, const Workload& workload, Strategy strategy,
+                        double checksum) {
+  // Every strategy must reproduce the values of the first one
+  Simulation<Strategy> check(strategy, workload);
+  check.Run(4 * workload.window);
+  if (check.checksum() != checksum) {
+    throw std::runtime_error("Strategy " + name + " changed the random values.");
+  }
+
+  const auto simulation = std::make_shared<Simulation<Strategy>>(std::move(strategy), workload);
+  bench::Benchmark benchmark;
+  benchmark.name = name;
+  benchmark.labels = labels;
+  benchmark.labels.emplace_back("strategy", name.substr(name.rfind('/') + 1));
+  benchmark.value_bytes = 0;
+  benchmark.run = [simulation](std::uint64_t events) {
+    simulation->Run(events);
+    return events;
+  };
+  benchmark.metrics = [simulation, workload] {
+    const double bytes = double(simulation->peak_bytes());
+    return std::vector<std::pair<std::string, double>>{
+        {"history_bytes", bytes}, {"bytes_per_event", bytes / double(2 * workload.window)}};
+  };
+  harness.Add(std::move(benchmark));
+}
+
+template <typename DistType, typename EngineType>
+static void AddDistribution(bench::Harness& harness, const std::string& engine,
+                            const std::string& distribution, Workload workload,
+                            const std::vector<std::uint32_t>& depths) {
+  using RNG = ReversibleRNG<DistType, EngineType>;
+  const RNG rng(Seed{42});
+
+  for (const std::uint32_t depth: depths) {
+    workload.depth = depth;
+    const std::string prefix = engine + "/" + distribution + "/depth=" + std::to_string(depth);
+    const bench::Labels labels = {
+        {"engine", engine}, {"distribution", distribution},
+        {"event_size", std::to_string(workload.event_size)},
+        {"rollback_fraction", std::to_string(workload.rollback_fraction)},
+        {"depth", std::to_string(depth)}};
+
+    Simulation<Previous<RNG>> reference(Previous<RNG>(rng), workload);
+    reference.Run(4 * workload.window);
+    const double checksum = reference.checksum();
+
+    AddStrategy(harness, labels, prefix + "/previous", workload, Previous<RNG>(rng), checksum);
+    AddStrategy(harness, labels, prefix + "/jump", workload, Jump<RNG>(rng), checksum);
+    AddStrategy(harness, labels, prefix + "/copy", workload, Copy<RNG>(rng), checksum);
+    AddStrategy(harness, labels, prefix + "/checkpoint", workload,
+                Checkpoint<RNG>(rng, workload.interval), checksum);
+  }
+}
+
+template <typename EngineType>
+static void AddEngine(bench::Harness& harness, const std::string& engine,
+                      const Workload& workload, const std::vector<std::uint32_t>& depths) {
+  AddDistribution<UniformDistribution<double>, EngineType>(
+      harness, engine, "uniform<double>", workload, depths);
+  AddDistribution<UniformDistribution<int>, EngineType>(
+      harness, engine, "uniform<int>", workload, depths);
+  AddDistribution<NormalDistribution<double>, EngineType>(
+      harness, engine, "normal<double>", workload, depths);
+  AddDistribution<ExponentialDistribution<double>, EngineType>(
+      harness, engine, "exponential<double>", workload, depths);
+}
+
+static std::vector<std::uint32_t> ParseDepths(const std::string& text) {
+  std::vector<std::uint32_t> depths;
+  std::size_t begin = 0;
+  while (begin <= text.size()) {
+    const std::size_t end = std::min(text.find(',', begin), text.size());
+    depths.push_back(std::stoul(text.substr(begin, end - begin)));
+    if (depths.back() == 0) {
+      throw std::invalid_argument("Rollback depths must be positive.");
+    }
+    begin = end + 1;
+  }
+  return depths;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    Workload workload;
+    std::vector<std::uint32_t> depths = {1, 10, 100, 1000};
+    bench::Options options;
+    options.unit = "event";
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 == argc) {
+          throw std::invalid_argument("Missing value of " + arg + ".");
+        }
+        return argv[++i];
+      };
+
+      if (arg == "--depths") {
+        depths = ParseDepths(value());
+      } else if (arg == "--event-size") {
+        workload.event_size = std::max<unsigned long>(1, std::stoul(value()));
+      } else if (arg == "--rollback-fraction") {
+        workload.rollback_fraction = std::stod(value());
+      } else if (arg == "--window") {
+        workload.window = std::stoul(value());
+      } else if (arg == "--interval") {
+        workload.interval = std::max<std::size_t>(1, std::stoul(value()));
+      } else if (arg == "--filter") {
+        options.filter = value();
+      } else if (arg == "--min-time") {
+        options.min_time = std::stod(value());
+      } else if (arg == "--repetitions") {
+        options.repetitions = std::stoul(value());
+      } else if (arg == "--format") {
+        options.format = value();
+      } else if (arg == "--output") {
+        output = value();
+      } else if (arg == "--help") {
+        std::cout << USAGE;
+        return EXIT_SUCCESS;
+      } else {
+        throw std::invalid_argument("Unknown option " + arg + ".");
+      }
+    }
+    if (workload.window < *std::max_element(depths.begin(), depths.end())) {
+      throw std::invalid_argument("The window must be at least the maximum depth.");
+    }
+
+    bench::Harness harness(options);
+    AddEngine<ReversiblePCG<pcg64>>(harness, "PCG64", workload, depths);
+    AddEngine<ReversibleMersenne>(harness, "Mersenne", workload, depths);
+
+    const std::vector<bench::Result> results = harness.Run();
+    if (output.empty()) {
+      harness.Report(results, std::cout);
+    } else {
+      std::ofstream file(output);
+      harness.Report(results, file);
+      if (!file) {
+        throw std::runtime_error("Cannot write " + output + ".");
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "rollback: " << e.what() << std::endl << USAGE;
+    return EXIT_FAILURE;
+  }
+}
@@ -32,6 +32,10 @@ class LoadWrapperLibrary(ctypes.CDLL):
         create.argtypes = [c_type] if is_exponential else [c_type, c_type]
         create.restype = ctypes.c_void_p
 
+        create_seeded = getattr(self, f"{type}_create_seeded")
+        create_seeded.argtypes = create.argtypes + [ctypes.c_ulonglong]
+        create_seeded.restype = ctypes.c_void_p
+
         destroy = getattr(self, f"{type}_destroy")
         destroy.argtypes = [ctypes.c_void_p]
         destroy.restype = None
@@ -66,7 +70,7 @@ class LoadWrapperLibrary(ctypes.CDLL):
 
 
 class UniformRealRNG:
-    def __init__(self, a=0.0, b=1.0, path=None):
+    def __init__(self, a=0.0, b=1.0, path=None, seed=None):
         if a > b:
             raise ValueError(f"a = {a} must be less than or equal to b = {b}.")
 
@@ -74,7 +78,10 @@ class UniformRealRNG:
         self._b = np.float64(b)
 
         self._lib = LoadWrapperLibrary(path)
-        self._rng = self._lib.uniform_real_create(self._a, self._b)
+        if seed is None:
+            self._rng = self._lib.uniform_real_create(self._a, self._b)
+        else:
+            self._rng = self._lib.uniform_real_create_seeded(self._a, self._b, seed)
 
     def __del__(self):
         if hasattr(self, "_rng"):
@@ -122,7 +129,7 @@ class UniformRealRNG:
 
 
 class UniformIntRNG:
-    def __init__(self, a=0, b=np.iinfo(np.intc).max, path=None):
+    def __init__(self, a=0, b=np.iinfo(np.intc).max, path=None, seed=None):
         if a > b:
             raise ValueError(f"a = {a} must be less than or equal to b = {b}.")
         if a < np.iinfo(np.intc).min or b > np.iinfo(np.intc).max:
@@ -134,7 +141,10 @@ class UniformIntRNG:
         self._b = np.intc(b)
 
         self._lib = LoadWrapperLibrary(path)
-        self._rng = self._lib.uniform_int_create(self._a, self._b)
+        if seed is None:
+            self._rng = self._lib.uniform_int_create(self._a, self._b)
+        else:
+            self._rng = self._lib.uniform_int_create_seeded(self._a, self._b, seed)
 
     def __del__(self):
         if hasattr(self, "_rng"):
@@ -182,7 +192,7 @@ class UniformIntRNG:
 
 
 class NormalRNG:
-    def __init__(self, mu=0.0, sigma=1.0, path=None):
+    def __init__(self, mu=0.0, sigma=1.0, path=None, seed=None):
         if sigma <= 0:
             raise ValueError(f"Sigma = {sigma} must be greater than 0.")
 
@@ -190,7 +200,10 @@ class NormalRNG:
         self._sigma = np.float64(sigma)
 
         self._lib = LoadWrapperLibrary(path)
-        self._rng = self._lib.normal_create(self._mu, self._sigma)
+        if seed is None:
+            self._rng = self._lib.normal_create(self._mu, self._sigma)
+        else:
+            self._rng = self._lib.normal_create_seeded(self._mu, self._sigma, seed)
 
     def __del__(self):
         if hasattr(self, "_rng"):
@@ -239,14 +252,17 @@ class NormalRNG:
 
 
 class ExponentialRNG:
-    def __init__(self, lambd=1.0, path=None):
+    def __init__(self, lambd=1.0, path=None, seed=None):
         if lambd <= 0:
             raise ValueError(f"Lambd = {lambd} must be greater than 0.")
 
         self._lambd = np.float64(lambd)
 
         self._lib = LoadWrapperLibrary(path)
-        self._rng = self._lib.exponential_create(self._lambd)
+        if seed is None:
+            self._rng = self._lib.exponential_create(self._lambd)
+        else:
+            self._rng = self._lib.exponential_create_seeded(self._lambd, seed)
 
     def __del__(self):
         if hasattr(self, "_rng"):
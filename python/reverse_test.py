@@ -1,3 +1,4 @@
+import inspect
 import numpy as np
 import pytest
 import random
@@ -36,6 +37,20 @@ class TestReverse:
 
         assert rng1.next() == rng2.next()
 
+    def test_seeded(self, reversible_rng):
+        sd = random.getrandbits(64)
+        rng1 = reversible_rng(seed=sd)
+        rng2 = reversible_rng()
+        rng2.seed(sd)
+
+        assert np.array_equal(rng1.next(self.N), rng2.next(self.N))
+
+    def test_positional_path(self, reversible_rng):
+        params = list(inspect.signature(reversible_rng).parameters.values())
+        args = [p.default for p in params if p.name != "path" and p.name != "seed"]
+        with pytest.raises(ValueError):
+            reversible_rng(*args, "/nonexistent/libWrapper.so")
+
     def test_invalid_size(self, reversible_rng):
         rng = reversible_rng()
         with pytest.raises(ValueError):
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pcg.h"
+#include "reverse.h"
+
+#include "pcg_extras.hpp"
+
+namespace reverse {
+
+/// Arena of many reversible random number generators (e.g. one per agent of a
+/// simulation) in a structure-of-arrays layout. Engine states, distributions
+/// and positions are stored in separate contiguous arrays, so stepping all (or
+/// a gathered subset of) generators streams through each array once. With
+/// `Padded`, every element occupies its own cache line, which avoids false
+/// sharing when threads step disjoint generators of a shared arena.
+///
+/// Generator i is the ith substream of a seeded master engine, and its
+/// sequence equals that of `ReversibleRNG::split(i)` on the master generator.
+/// Every value uses one call of the distribution, so buffered distributions
+/// (see BlockSize) are not supported.
+template <typename DistType = UniformDistribution<>,
+          typename EngineType = ReversiblePCG<>,
+          bool Padded = false>
+class ReversibleRNGArena {
+  static_assert(BlockSize<DistType, EngineType>::value == 1,
+      "Distribution must produce one value per draw");
+
+  template <typename T>
+  struct alignas(64) CacheLine {
+    T value;
+  };
+
+  template <typename T>
+  using Array = std::vector<typename std::conditional<Padded, CacheLine<T>, T>::type>;
+ public:
+  using result_type = typename DistType::result_type;
+  using distribution_type = DistType;
+  using engine_type = EngineType;
+
+  explicit ReversibleRNGArena(std::size_t size, const DistType& distribution = DistType())
+      : engines_(size), distributions_(size), positions_(size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      get(distributions_, i) = distribution;
+    }
+
+    // Randomly seed from a non-deterministic source if available e.g. /dev/random
+    pcg_extras::seed_seq_from<std::random_device> seed_source;
+    EngineType master;
+    master.seed(seed_source);
+    seed_all(master);
+  }
+
+  // Seeds every generator with a substream of the seeded master engine
+  template <typename... Args>
+  void seed(Args&&... params) {
+    EngineType master;
+    master.seed(std::forward<Args>(params)...);
+    seed_all(master);
+  }
+
+  // Returns the number of generators
+  std::size_t size() const { return engines_.size(); }
+
+  // Returns the distribution of the ith generator
+  DistType& distribution(std::size_t i) { return get(distributions_, i); }
+  const DistType& distribution(std::size_t i) const { return get(distributions_, i); }
+
+  // Returns the position of the ith generator
+  std::int64_t position(std::size_t i) const { return get(positions_, i); }
+
+  // Returns the next value of every generator
+  std::vector<result_type> step_all_forward() {
+    std::vector<result_type> values(size());
+    step_all_forward(values.data());
+    return values;
+  }
+
+  // Returns the previous value of every generator
+  std::vector<result_type> step_all_backward() {
+    std::vector<result_type> values(size());
+    step_all_backward(values.data());
+    return values;
+  }
+
+  // Writes the next value of every generator to `out`
+  void step_all_forward(result_type* out) {
+    for (std::size_t i = 0; i < size(); ++i) {
+      out[i] = forward(i);
+    }
+  }
+
+  // Writes the previous value of every generator to `out`
+  void step_all_backward(result_type* out) {
+    for (std::size_t i = 0; i < size(); ++i) {
+      out[i] = backward(i);
+    }
+  }
+
+  // Writes the next values of the generators at the given indices to `out`
+  void step_forward(const std::vector<std::size_t>& indices, result_type* out) {
+    for (std::size_t n = 0; n < indices.size(); ++n) {
+      out[n] = forward(indices[n]);
+    }
+  }
+
+  // Writes the previous values of the generators at the given indices to `out`
+  void step_backward(const std::vector<std::size_t>& indices, result_type* out) {
+    for (std::size_t n = 0; n < indices.size(); ++n) {
+      out[n] = backward(indices[n]);
+    }
+  }
+ private:
+  // Returns the ith element of an array (without its padding)
+  template <typename ArrayType>
+  static auto& get(ArrayType& array, std::size_t i) {
+    if constexpr (Padded) {
+      return array[i].value;
+    } else {
+      return array[i];
+    }
+  }
+
+  void seed_all(const EngineType& master) {
+    for (std::size_t i = 0; i < size(); ++i) {
+      get(engines_, i) = util::substream(master, i);
+      get(distributions_, i).reset();
+      get(positions_, i) = 0;
+    }
+  }
+
+  result_type forward(std::size_t i) {
+    get(positions_, i)++;
+    return get(distributions_, i)(get(engines_, i));
+  }
+
+  result_type backward(std::size_t i) {
+    get(positions_, i)--;
+    ReversedEngine reversed(get(engines_, i));
+    return get(distributions_, i)(reversed);
+  }
+
+  Array<EngineType> engines_;
+  Array<DistType> distributions_;
+  Array<std::int64_t> positions_;
+};
+
+} // namespace reverse
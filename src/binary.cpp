@@ -0,0 +1 @@
+#include "binary.h"
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+namespace reverse {
+
+namespace util {
+
+// Writes an integer or floating point value to `out` in little-endian byte
+// order, independent of the host, and returns the end of the written bytes.
+// Integers wider than 64 bits (e.g. the 128-bit PCG state) are written as
+// their least significant 64-bit word first.
+template <typename T>
+std::byte* store(std::byte* out, T value) {
+  if constexpr (std::is_floating_point<T>::value) {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Unsupported floating point size");
+    using BitsType = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+    BitsType bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    return store(out, bits);
+  } else if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+    out = store(out, std::uint64_t(value));
+    return store(out, std::uint64_t(value >> 64));
+  } else {
+    using UnsignedType = typename std::make_unsigned<T>::type;
+    const UnsignedType bits = UnsignedType(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      out[i] = std::byte(bits >> (8 * i) & 0xff);
+    }
+    return out + sizeof(T);
+  }
+}
+
+// Reads a value written by `store` and returns the end of the read bytes
+template <typename T>
+const std::byte* fetch(const std::byte* in, T& value) {
+  if constexpr (std::is_floating_point<T>::value) {
+    using BitsType = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+    BitsType bits;
+    in = fetch(in, bits);
+    std::memcpy(&value, &bits, sizeof(T));
+    return in;
+  } else if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+    std::uint64_t low, high;
+    in = fetch(in, low);
+    in = fetch(in, high);
+    value = T(high) << 64 | low;
+    return in;
+  } else {
+    using UnsignedType = typename std::make_unsigned<T>::type;
+    UnsignedType bits = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      bits |= UnsignedType(std::to_integer<UnsignedType>(in[i])) << (8 * i);
+    }
+    value = T(bits);
+    return in + sizeof(T);
+  }
+}
+
+} // namespace util
+
+// Writes the binary form of `count` consecutive objects (e.g. generators) to
+// `out`, which holds at least `count * T::binary_size` bytes. Returns the end
+// of the written bytes.
+template <typename T>
+std::byte* save(const T* first, std::size_t count, std::byte* out) {
+  for (std::size_t i = 0; i < count; ++i) {
+    out = first[i].save(out);
+  }
+  return out;
+}
+
+// Reads `count` consecutive objects written by `save`. Returns the end of the
+// read bytes.
+template <typename T>
+const std::byte* load(T* first, std::size_t count, const std::byte* in) {
+  for (std::size_t i = 0; i < count; ++i) {
+    in = first[i].load(in);
+  }
+  return in;
+}
+
+#ifdef __cpp_lib_span
+// Writes the binary form of all objects to the front of `out`, and returns the
+// remaining bytes
+template <typename T>
+std::span<std::byte> save(std::span<const T> objects, std::span<std::byte> out) {
+  if (out.size() < objects.size() * T::binary_size) {
+    throw std::invalid_argument("Buffer is too small for the binary form of the objects.");
+  }
+  return out.subspan(save(objects.data(), objects.size(), out.data()) - out.data());
+}
+
+// Reads all objects from the front of `in`, and returns the remaining bytes
+template <typename T>
+std::span<const std::byte> load(std::span<T> objects, std::span<const std::byte> in) {
+  if (in.size() < objects.size() * T::binary_size) {
+    throw std::invalid_argument("Buffer is too small for the binary form of the objects.");
+  }
+  return in.subspan(load(objects.data(), objects.size(), in.data()) - in.data());
+}
+#endif
+
+} // namespace reverse
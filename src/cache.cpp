@@ -0,0 +1 @@
+#include "cache.h"
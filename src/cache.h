@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "pcg.h"
+#include "reverse.h"
+#include "ring.h"
+
+namespace reverse {
+
+/// Reversible random number generator with a cache of up to `Capacity` values
+/// around its position. Values can be peeked at in both directions without
+/// consuming them, and `next`/`previous` are served from the cache while it
+/// covers the target position. The engine only moves to extend the cache at
+/// either end (or to a position outside of it), so its position is tracked
+/// separately from the position of the generator. The generator is
+/// implemented in terms of a ReversibleRNG (a private base), whose engine is
+/// moved to the position of the generator wherever the engine state is used,
+/// e.g. for splits and comparisons.
+template <typename DistType = UniformDistribution<>,
+          typename EngineType = ReversiblePCG<>,
+          std::size_t Capacity = 64>
+class CachedRNG : private ReversibleRNG<DistType, EngineType> {
+  using Base = ReversibleRNG<DistType, EngineType>;
+ public:
+  using typename Base::result_type;
+  using typename Base::distribution_type;
+  using typename Base::engine_type;
+
+  using Base::block_size;
+  using Base::binary_version;
+
+  using Base::Base;
+
+  using Base::min;
+  using Base::max;
+  using Base::position;
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    Base::seed(std::forward<Args>(params)...);
+    clear();
+  }
+
+  // Returns the number of cached values
+  std::size_t cached() const { return window_.size(); }
+
+  void discard(unsigned long long z) { seek(Base::position_ + std::int64_t(z)); }
+
+  result_type operator()() { return next(); }
+
+  result_type next() {
+    const result_type value = peek(0);
+    Base::position_++;
+    return value;
+  }
+
+  result_type previous() {
+    const result_type value = peek_back(0);
+    Base::position_--;
+    return value;
+  }
+
+  std::vector<result_type> next(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.begin(), values.end(), [&] { return next(); });
+    return values;
+  }
+
+  std::vector<result_type> previous(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.rbegin(), values.rend(), [&] { return previous(); });
+    return values;
+  }
+
+  template <std::size_t N>
+  auto next() {
+    return Base::get(std::make_index_sequence<N>{}, next(N));
+  }
+
+  template <std::size_t N>
+  auto previous() {
+    return Base::get(std::make_index_sequence<N>{}, previous(N));
+  }
+
+  // Returns the `k`th next value without moving (zero is the value of `next`)
+  result_type peek(std::size_t k) { return at(Base::position_ + std::int64_t(k), k); }
+
+  // Returns the `k`th previous value without moving (zero is the value of
+  // `previous`)
+  result_type peek_back(std::size_t k) { return at(Base::position_ - 1 - std::int64_t(k), k); }
+
+  // Moves to the given position. The engine moves on the next access outside
+  // of the cache.
+  void seek(std::int64_t position) { Base::position_ = position; }
+
+  // See ReversibleRNG::child_seed
+  std::uint64_t child_seed(std::uint64_t id) const { return synced().Base::child_seed(id); }
+
+  // See ReversibleRNG::ahead
+  Base ahead(std::int64_t draws) const { return synced().Base::ahead(draws); }
+
+  // See ReversibleRNG::split
+  Base split(std::uint64_t stream_id) const { return synced().Base::split(stream_id); }
+
+  static constexpr std::size_t binary_size = Base::binary_size + sizeof(std::int64_t);
+
+  std::byte* save(std::byte* out) const {
+    return util::store(Base::save(out), engine_position_);
+  }
+
+  const std::byte* load(const std::byte* in) {
+    in = util::fetch(Base::load(in), engine_position_);
+    window_.clear();
+    start_ = engine_position_;
+    return in;
+  }
+
+  // Generators are equal if their engines are equal at their positions,
+  // regardless of the cached values
+  friend bool operator==(const CachedRNG& lhs, const CachedRNG& rhs) {
+    return static_cast<const Base&>(lhs.synced()) == static_cast<const Base&>(rhs.synced());
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const CachedRNG& rng) {
+    const auto flags = os.flags(std::ios_base::dec | std::ios_base::left);
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << static_cast<const Base&>(rng) << space << rng.engine_position_;
+
+    os.flags(flags);
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, CachedRNG& rng) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    is >> static_cast<Base&>(rng) >> rng.engine_position_;
+    rng.window_.clear();
+    rng.start_ = rng.engine_position_;
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  void clear() {
+    window_.clear();
+    start_ = engine_position_ = 0;
+  }
+
+  // Returns the value at the given position, which is `k` values away from the
+  // position of the generator. Extends the cache towards the position, or
+  // restarts it there if the position is more than a cache length away.
+  result_type at(std::int64_t position, std::size_t k) {
+    if (k >= Capacity) {
+      throw std::out_of_range("Cannot peek past the capacity of the cache.");
+    }
+
+    constexpr std::int64_t capacity = Capacity;
+    std::int64_t end = start_ + std::int64_t(window_.size());
+    if (window_.empty() || position < start_ - capacity || position >= end + capacity) {
+      window_.clear();
+      start_ = end = position;
+    }
+
+    while (end <= position) {
+      if (window_.full()) {
+        start_++;
+      }
+      window_.push_back(generate(end++, true));
+    }
+    while (start_ > position) {
+      window_.push_front(generate(--start_, false));
+    }
+    return window_[position - start_];
+  }
+
+  // Returns a copy whose engine is at the position of the generator
+  CachedRNG synced() const {
+    CachedRNG rng(*this);
+    const std::int64_t position = rng.Base::position_;
+    rng.Base::position_ = rng.engine_position_;
+    rng.Base::seek(position);
+    rng.engine_position_ = position;
+    return rng;
+  }
+
+  // Generates the value at the given position with the engine, forwards or
+  // backwards
+  result_type generate(std::int64_t position, bool forward) {
+    std::swap(Base::position_, engine_position_);
+    Base::seek(forward ? position : position + 1);
+    const result_type value = forward ? Base::next() : Base::previous();
+    std::swap(Base::position_, engine_position_);
+    return value;
+  }
+
+  RingBuffer<result_type> window_{Capacity};
+  // Position of the first cached value, and of the engine
+  std::int64_t start_ = 0;
+  std::int64_t engine_position_ = 0;
+};
+
+} // namespace reverse
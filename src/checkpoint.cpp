@@ -0,0 +1 @@
+#include "checkpoint.h"
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xoshiro.h"
+
+namespace reverse {
+
+/// Adapter class that makes a non-invertible uniform random bit generator
+/// (e.g. `std::mt19937`) reversible by periodically saving its state. A
+/// checkpoint (copy of the engine) is recorded every `interval` draws. The
+/// `previous` function restores the nearest checkpoint and regenerates its
+/// block of draws into a buffer, which then serves the following reversed (or
+/// repeated forward) draws. Hence, reversing costs about one forward draw per
+/// value, and one checkpoint per `interval` draws is stored.
+///
+/// With a fixed interval, checkpoints are kept in a ring of `capacity`
+/// entries, and the engine can only be reversed by about `interval * capacity`
+/// draws. With an automatic interval (zero), the engine can always be
+/// reversed back to its seed. When the arena of checkpoints is full, every
+/// other checkpoint is dropped and the interval is doubled, which bounds the
+/// memory and keeps the recompute time logarithmic in the sequence length.
+template <typename URBG>
+class CheckpointedEngine {
+ public:
+  using result_type = typename URBG::result_type;
+
+  // A snapshot costs about an eighth of the bytes generated in its interval
+  static constexpr std::size_t default_interval =
+      std::max<std::size_t>(64, 8 * sizeof(URBG) / sizeof(result_type));
+
+  static constexpr std::size_t default_capacity = 1024;
+
+  CheckpointedEngine() = default;
+
+  template <typename... Args, typename = typename
+      std::enable_if<std::is_constructible<URBG, Args&&...>::value>::type>
+  explicit CheckpointedEngine(Args&&... args) : engine_(std::forward<Args>(args)...) {}
+
+  template <typename... Args>
+  void seed(Args&&... args) {
+    engine_.seed(std::forward<Args>(args)...);
+    interval_ = automatic_ ? default_interval : interval_;
+    clear();
+  }
+
+  // Sets the checkpoint interval (zero for automatic) and the maximum number
+  // of checkpoints. The current state becomes the start of the sequence.
+  void configure(std::size_t interval, std::size_t capacity = default_capacity) {
+    if (capacity < 2) {
+      throw std::invalid_argument("Checkpoint capacity must be at least 2.");
+    }
+
+    engine_ = state();
+    automatic_ = interval == 0;
+    interval_ = automatic_ ? default_interval : interval;
+    capacity_ = capacity;
+    clear();
+  }
+
+  // Returns the current checkpoint interval in draws
+  std::size_t interval() const { return interval_; }
+
+  // Returns the maximum number of stored checkpoints
+  std::size_t capacity() const { return capacity_; }
+
+  // Returns the number of stored checkpoints
+  std::size_t checkpoints() const { return checkpoints_.size(); }
+
+  static constexpr result_type min() { return URBG::min(); }
+  static constexpr result_type max() { return URBG::max(); }
+
+  void discard(unsigned long long z) {
+    for (; z != 0ULL; --z) {
+      next();
+    }
+  }
+
+  result_type operator()() { return next(); }
+
+  result_type next() {
+    if (buffered(position_)) {
+      return buffer_[position_++ - buffer_start_];
+    }
+
+    if (engine_position_ != position_) {
+      restore(position_);
+    }
+
+    position_++;
+    return generate();
+  }
+
+  result_type previous() {
+    if (position_ == 0) {
+      throw std::runtime_error("Cannot reverse past the start of the sequence.");
+    }
+
+    const std::uint64_t target = position_ - 1;
+    if (!buffered(target)) {
+      fill(target / interval_);
+    }
+
+    position_--;
+    return buffer_[target - buffer_start_];
+  }
+
+  // Returns the number of draws since the engine was seeded
+  std::uint64_t position() const { return position_; }
+
+  // Returns an engine on the `i`th substream of the underlying engine (see
+  // util::substream) with the same checkpoint configuration
+  CheckpointedEngine substream(std::uint64_t i) const {
+    CheckpointedEngine engine(util::substream(state(), i));
+    engine.configure(automatic_ ? 0 : interval_, capacity_);
+    return engine;
+  }
+
+  // Returns a copy of the underlying engine at the current position
+  URBG state() const {
+    if (engine_position_ == position_) {
+      return engine_;
+    }
+
+    const std::uint64_t index = checkpoint(position_);
+    URBG engine = checkpoints_[index - first_];
+    engine.discard(position_ - index * interval_);
+    return engine;
+  }
+
+  friend bool operator==(const CheckpointedEngine& lhs, const CheckpointedEngine& rhs) {
+    return lhs.position_ == rhs.position_ && lhs.state() == rhs.state();
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const CheckpointedEngine& rng) {
+    const auto flags = os.flags(std::ios_base::dec | std::ios_base::fixed | std::ios_base::left);
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << rng.automatic_ << space << rng.interval_ << space << rng.capacity_ << space
+       << rng.first_ << space << rng.checkpoints_.size() << space;
+    for (const auto& checkpoint: rng.checkpoints_) {
+      os << checkpoint << space;
+    }
+    os << rng.state() << space << rng.position_;
+
+    os.flags(flags);
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, CheckpointedEngine& rng) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    std::size_t size;
+    is >> rng.automatic_ >> rng.interval_ >> rng.capacity_ >> rng.first_ >> size;
+    rng.checkpoints_.resize(size);
+    for (auto& checkpoint: rng.checkpoints_) {
+      is >> checkpoint;
+    }
+    is >> rng.engine_ >> rng.position_;
+    rng.engine_position_ = rng.position_;
+    rng.buffer_.clear();
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  void clear() {
+    checkpoints_.clear();
+    buffer_.clear();
+    first_ = 0;
+    position_ = engine_position_ = 0;
+  }
+
+  bool buffered(std::uint64_t position) const {
+    return position >= buffer_start_ && position - buffer_start_ < buffer_.size();
+  }
+
+  // Returns the index of the last stored checkpoint at or before `position`
+  std::uint64_t checkpoint(std::uint64_t position) const {
+    if (checkpoints_.empty() || position < first_ * interval_) {
+      throw std::runtime_error("Position precedes the oldest checkpoint.");
+    }
+    return std::min<std::uint64_t>(position / interval_, first_ + checkpoints_.size() - 1);
+  }
+
+  // Draws from the underlying engine and records a checkpoint if one is due
+  result_type generate() {
+    if (engine_position_ % interval_ == 0
+        && engine_position_ / interval_ == first_ + checkpoints_.size()) {
+      record();
+    }
+
+    engine_position_++;
+    return engine_();
+  }
+
+  void record() {
+    if (checkpoints_.size() == capacity_) {
+      if (automatic_) {
+        thin();
+        if (engine_position_ % interval_ != 0) {
+          return;
+        }
+      } else {
+        checkpoints_.pop_front();
+        first_++;
+      }
+    }
+
+    checkpoints_.push_back(engine_);
+  }
+
+  // Drops every other checkpoint and doubles the interval (first_ is zero)
+  void thin() {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < checkpoints_.size(); i += 2) {
+      checkpoints_[size++] = std::move(checkpoints_[i]);
+    }
+    checkpoints_.resize(size);
+    interval_ *= 2;
+  }
+
+  // Moves the underlying engine to `position` from the nearest checkpoint
+  void restore(std::uint64_t position) {
+    const std::uint64_t index = checkpoint(position);
+    engine_ = checkpoints_[index - first_];
+    engine_position_ = index * interval_;
+    while (engine_position_ < position) {
+      generate();
+    }
+  }
+
+  // Regenerates the values of the `index`th block of draws into the buffer
+  void fill(std::uint64_t index) {
+    restore(index * interval_);
+    buffer_start_ = engine_position_;
+    buffer_.resize(interval_);
+    std::generate(buffer_.begin(), buffer_.end(), [this] { return generate(); });
+  }
+
+  URBG engine_;
+  std::uint64_t engine_position_ = 0;
+  std::uint64_t position_ = 0;
+
+  std::deque<URBG> checkpoints_;
+  std::uint64_t first_ = 0;
+  std::size_t interval_ = default_interval;
+  std::size_t capacity_ = default_capacity;
+  bool automatic_ = true;
+
+  std::vector<result_type> buffer_;
+  std::uint64_t buffer_start_ = 0;
+};
+
+} // namespace reverse
@@ -0,0 +1 @@
+#include "counting.h"
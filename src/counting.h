@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pcg.h"
+#include "reverse.h"
+
+namespace reverse {
+
+/// Log of the number of engine draws of consecutive values. Counts are stored
+/// with a variable-length (LEB128) encoding, which is a single byte for fewer
+/// than 128 draws. The least significant 7-bit groups come first with their
+/// continuation bit set. Hence, the final byte of every entry has its high bit
+/// clear and the log can be decoded from the back.
+class DrawLog {
+ public:
+  // Appends a draw count to the log
+  void push(std::uint64_t count) {
+    while (count >= 0x80) {
+      bytes_.push_back(std::uint8_t(count | 0x80));
+      count >>= 7;
+    }
+    bytes_.push_back(std::uint8_t(count));
+  }
+
+  // Removes and returns the last draw count of the log
+  std::uint64_t pop() {
+    if (bytes_.empty()) {
+      throw std::runtime_error("Draw count log is empty, the value cannot be reversed.");
+    }
+
+    std::uint64_t count = bytes_.back();
+    bytes_.pop_back();
+    while (!bytes_.empty() && (bytes_.back() & 0x80)) {
+      count = count << 7 | (bytes_.back() & 0x7f);
+      bytes_.pop_back();
+    }
+    return count;
+  }
+
+  void clear() { bytes_.clear(); }
+
+  bool empty() const { return bytes_.empty(); }
+
+  // Returns the size of the log in bytes
+  std::size_t size() const { return bytes_.size(); }
+
+  friend bool operator==(const DrawLog& lhs, const DrawLog& rhs) {
+    return lhs.bytes_ == rhs.bytes_;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const DrawLog& log) {
+    const auto flags = os.flags(std::ios_base::dec | std::ios_base::left);
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << log.bytes_.size();
+    for (const auto byte: log.bytes_) {
+      os << space << unsigned(byte);
+    }
+
+    os.flags(flags);
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, DrawLog& log) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    std::size_t size;
+    is >> size;
+    log.bytes_.resize(size);
+    for (auto& byte: log.bytes_) {
+      unsigned value;
+      is >> value;
+      byte = value;
+    }
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  std::vector<std::uint8_t> bytes_;
+};
+
+/// Adapter class that makes an arbitrary distribution (e.g.
+/// `std::gamma_distribution`) reversible on top of a reversible uniform random
+/// number generator (RURNG). Every forward call counts the engine draws that
+/// the wrapped distribution consumes and appends that count to a log with a
+/// variable-length encoding (DrawLog), which is a single byte for fewer than
+/// 128 draws. A reversed call pops the last count, rewinds the engine by that
+/// many draws (in logarithmic time for engines with `backstep`, see
+/// util::advance) and recomputes the value from a copy of the engine. The wrapped
+/// distribution is reset before every call so that each value only depends on
+/// the engine position.
+template <typename DistType>
+class CountingReversibleAdapter {
+ public:
+  using result_type = typename DistType::result_type;
+
+  template <typename... Args, typename = typename
+      std::enable_if<std::is_constructible<DistType, Args&&...>::value>::type>
+  explicit CountingReversibleAdapter(Args&&... args)
+      : distribution_(std::forward<Args>(args)...) {}
+
+  // Resets the distribution state and clears the draw count log
+  void reset() {
+    distribution_.reset();
+    log_.clear();
+  }
+
+  // Returns the wrapped distribution
+  const DistType& distribution() const { return distribution_; }
+
+  // Returns the size of the draw count log in bytes
+  std::size_t log_size() const { return log_.size(); }
+
+  result_type min() const { return distribution_.min(); }
+  result_type max() const { return distribution_.max(); }
+
+  template <typename URNG>
+  result_type operator()(URNG& urng) {
+    CountingEngine<URNG> counter(urng);
+    distribution_.reset();
+    const result_type result = distribution_(counter);
+    log_.push(counter.count());
+    return result;
+  }
+
+  template <typename RURNG>
+  result_type operator()(ReversedEngine<RURNG>& reversed) {
+    RURNG& engine = reversed.engine();
+    util::advance(engine, -std::int64_t(log_.pop()));
+
+    RURNG replay(std::as_const(engine));
+    distribution_.reset();
+    return distribution_(replay);
+  }
+
+  friend bool operator==(const CountingReversibleAdapter& lhs,
+                         const CountingReversibleAdapter& rhs) {
+    return lhs.distribution_ == rhs.distribution_ && lhs.log_ == rhs.log_;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const CountingReversibleAdapter& dist) {
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << dist.distribution_ << space << dist.log_;
+
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, CountingReversibleAdapter& dist) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    is >> dist.distribution_ >> dist.log_;
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  DistType distribution_;
+  DrawLog log_;
+};
+
+// Convenience type definition for a reversible random number generator on an
+// arbitrary distribution e.g. `CountingRNG<std::gamma_distribution<>>`.
+template <typename DistType, typename EngineType = ReversiblePCG<>>
+using CountingRNG = ReversibleRNG<CountingReversibleAdapter<DistType>, EngineType>;
+
+} // namespace reverse
@@ -0,0 +1 @@
+#include "event.h"
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+#include "reverse.h"
+
+namespace reverse {
+
+/// Start of an event on the random number sequence of a generator, which can
+/// be rolled back e.g. in an optimistic (Time Warp) parallel simulation. The
+/// event index counts all marks of the generator since it was seeded.
+struct EventMark {
+  std::uint64_t event;
+  std::int64_t position;
+};
+
+/// Generator with event marks that can be rolled back, e.g. an EventRNG over
+/// a ReversibleRNG, IndexedRNG or CachedRNG. The marks are the positions at
+/// the start of the uncommitted events, which are dropped from the front on
+/// commit (fossil collection). Rollbacks use the `seek` function of the
+/// generator, which jumps the engine for distributions with a fixed number of
+/// draws per value. Copies keep their marks, but the stream operators and the
+/// binary form of the generator do not save them.
+template <typename RNG = UniformRNG<>>
+class EventRNG : public RNG {
+ public:
+  using RNG::RNG;
+
+  // Constructs a generator without events from a copy of the given generator
+  explicit EventRNG(const RNG& rng) : RNG(rng) {}
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    RNG::seed(std::forward<Args>(params)...);
+    marks_.clear();
+    first_event_ = 0;
+  }
+
+  // Marks the start of an event at the current position
+  EventMark mark() {
+    marks_.push_back(RNG::position());
+    return {first_event_ + marks_.size() - 1, RNG::position()};
+  }
+
+  // Rolls back the given number of most recent events
+  void rollback(std::size_t events) {
+    if (events > marks_.size()) {
+      throw std::invalid_argument("Cannot roll back committed events.");
+    }
+    if (events == 0) {
+      return;
+    }
+
+    const std::int64_t position = marks_[marks_.size() - events];
+    marks_.resize(marks_.size() - events);
+    RNG::seek(position);
+  }
+
+  // Rolls back all events since the given mark (inclusive)
+  void rollback_to(const EventMark& mark) { rollback(events_since(mark)); }
+
+  // Commits (fossil collects) the given number of earliest events. These
+  // events can no longer be rolled back.
+  void commit(std::size_t events) {
+    if (events > marks_.size()) {
+      throw std::invalid_argument("Cannot commit more events than were marked.");
+    }
+    marks_.erase(marks_.begin(), marks_.begin() + events);
+    first_event_ += events;
+  }
+
+  // Commits all events before the given mark
+  void commit(const EventMark& mark) { commit(marks_.size() - events_since(mark)); }
+
+  // Returns the number of events that can be rolled back
+  std::size_t events() const { return marks_.size(); }
+ private:
+  // Returns the number of uncommitted events since the given mark (inclusive)
+  std::size_t events_since(const EventMark& mark) const {
+    if (mark.event < first_event_ || mark.event - first_event_ >= marks_.size()) {
+      throw std::invalid_argument("Event mark is committed or rolled back.");
+    }
+    return first_event_ + marks_.size() - mark.event;
+  }
+
+  std::deque<std::int64_t> marks_;
+  std::uint64_t first_event_ = 0;
+};
+
+} // namespace reverse
@@ -2,12 +2,15 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <ios>
 #include <istream>
 #include <limits>
 #include <ostream>
 #include <type_traits>
 
+#include "binary.h"
 #include "uniform.h"
 
 namespace reverse {
@@ -42,6 +45,16 @@ class ExponentialDistribution {
     return -std::log1p(-util::canonical(urng)) / lambda();
   }
 
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = sizeof(result_type);
+
+  // Writes the parameter in little-endian byte order and returns the end of
+  // the written bytes
+  std::byte* save(std::byte* out) const { return util::store(out, lambda_); }
+
+  // Reads the parameter written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) { return util::fetch(in, lambda_); }
+
   friend bool operator==(const ExponentialDistribution& lhs, const ExponentialDistribution& rhs) {
     return lhs.lambda() == rhs.lambda();
   }
@@ -0,0 +1 @@
+#include "index.h"
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "normal.h"
+#include "pcg.h"
+#include "reverse.h"
+
+namespace reverse {
+
+/// Reversible random number generator with a sparse index for seeking on
+/// rejection-based distributions e.g. NormalDistribution. The engine offset of
+/// a position is unknown for these distributions, since the number of draws
+/// per value varies. During forward generation, the engine state and offset
+/// (number of draws) are recorded every K values. The `seek` function then
+/// binary searches the index, restores the engine and replays at most K
+/// values. K is chosen from the measured number of draws per value such that
+/// a replay costs about `replay_draws` engine draws. The index holds at most
+/// `capacity` entries, after which every other entry is dropped and K is
+/// doubled.
+///
+/// Buffered distributions (see BlockSize) already seek in constant time, and
+/// are not indexed. The generator is implemented in terms of a ReversibleRNG
+/// (a private base), so that the index cannot be bypassed through a reference
+/// to the base.
+template <typename DistType = NormalDistribution<>,
+          typename EngineType = ReversiblePCG<>>
+class IndexedRNG : private ReversibleRNG<DistType, EngineType> {
+  using Base = ReversibleRNG<DistType, EngineType>;
+ public:
+  using typename Base::result_type;
+  using typename Base::distribution_type;
+  using typename Base::engine_type;
+
+  using Base::block_size;
+  using Base::binary_version;
+  using Base::binary_size;
+
+  static constexpr std::size_t default_replay_draws = 1024;
+  static constexpr std::size_t default_capacity = 4096;
+
+  using Base::Base;
+
+  using Base::min;
+  using Base::max;
+  using Base::position;
+  using Base::child_seed;
+  using Base::ahead;
+  using Base::split;
+  using Base::save;
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    Base::seed(std::forward<Args>(params)...);
+    clear();
+  }
+
+  // Sets the target number of engine draws per replay and the maximum number
+  // of index entries. Clears the index.
+  void configure(std::size_t replay_draws, std::size_t capacity = default_capacity) {
+    if (replay_draws == 0 || capacity < 2) {
+      throw std::invalid_argument("Index requires replay draws > 0 and capacity >= 2.");
+    }
+
+    replay_draws_ = replay_draws;
+    capacity_ = capacity;
+    clear();
+  }
+
+  // Returns the current number of values between index entries (K)
+  std::size_t interval() const { return stride_ * base_interval_; }
+
+  // Returns the number of index entries
+  std::size_t entries() const { return index_.size(); }
+
+  // Returns the number of engine draws since the engine was seeded (or
+  // streamed in)
+  std::int64_t offset() const {
+    if constexpr (block_size > 1) {
+      return this->draw_;
+    } else {
+      return offset_;
+    }
+  }
+
+  void discard(unsigned long long z) {
+    for (; z != 0ULL; --z) {
+      next();
+    }
+  }
+
+  result_type operator()() { return next(); }
+
+  result_type next() {
+    if constexpr (block_size > 1) {
+      return Base::next();
+    } else {
+      if (index_.empty() || Base::position_ - index_.back().position >= std::int64_t(interval())) {
+        record();
+      }
+
+      CountingEngine counter(Base::engine_);
+      const result_type result = Base::distribution_(counter);
+      offset_ += counter.count();
+      Base::position_++;
+      return result;
+    }
+  }
+
+  result_type previous() {
+    if constexpr (block_size > 1) {
+      return Base::previous();
+    } else {
+      ReversedEngine reversed(Base::engine_);
+      CountingEngine counter(reversed);
+      const result_type result = Base::distribution_(counter);
+      offset_ -= counter.count();
+      Base::position_--;
+      return result;
+    }
+  }
+
+  std::vector<result_type> next(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.begin(), values.end(), [&] { return next(); });
+    return values;
+  }
+
+  std::vector<result_type> previous(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.rbegin(), values.rend(), [&] { return previous(); });
+    return values;
+  }
+
+  template <std::size_t N>
+  auto next() {
+    return Base::get(std::make_index_sequence<N>{}, next(N));
+  }
+
+  template <std::size_t N>
+  auto previous() {
+    return Base::get(std::make_index_sequence<N>{}, previous(N));
+  }
+
+  // Moves to the given position on the random number sequence. Restores the
+  // closest preceding index entry if that requires fewer steps than moving
+  // from the current position.
+  void seek(std::int64_t position) {
+    if constexpr (block_size > 1) {
+      Base::seek(position);
+    } else {
+      auto it = std::upper_bound(index_.begin(), index_.end(), position,
+          [](std::int64_t p, const Entry& entry) { return p < entry.position; });
+
+      if (it != index_.begin()) {
+        const Entry& entry = *std::prev(it);
+        const std::int64_t distance = position > Base::position_
+            ? position - Base::position_ : Base::position_ - position;
+        if (position - entry.position < distance) {
+          Base::engine_ = entry.engine;
+          Base::position_ = entry.position;
+          offset_ = entry.offset;
+        }
+      }
+
+      while (Base::position_ < position) {
+        next();
+      }
+      while (Base::position_ > position) {
+        previous();
+      }
+    }
+  }
+
+  const std::byte* load(const std::byte* in) {
+    in = Base::load(in);
+    clear();
+    return in;
+  }
+
+#ifdef __cpp_lib_span
+  std::span<const std::byte> load(std::span<const std::byte> in) {
+    in = Base::load(in);
+    clear();
+    return in;
+  }
+#endif
+
+  friend bool operator==(const IndexedRNG& lhs, const IndexedRNG& rhs) {
+    return static_cast<const Base&>(lhs) == static_cast<const Base&>(rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const IndexedRNG& rng) {
+    return os << static_cast<const Base&>(rng);
+  }
+
+  friend std::istream& operator>>(std::istream& is, IndexedRNG& rng) {
+    is >> static_cast<Base&>(rng);
+    rng.clear();
+    return is;
+  }
+ private:
+  struct Entry {
+    std::int64_t position;
+    std::int64_t offset;
+    EngineType engine;
+  };
+
+  void clear() {
+    index_.clear();
+    offset_ = 0;
+    stride_ = 1;
+    base_interval_ = replay_draws_;
+  }
+
+  // Records an entry at the current position, which is past the last entry
+  void record() {
+    if (!index_.empty()) {
+      // Measured number of draws per value over the indexed range
+      const Entry& first = index_.front();
+      const double ratio = double(offset_ - first.offset) / (Base::position_ - first.position);
+      base_interval_ = std::max<std::size_t>(1, replay_draws_ / std::max(ratio, 1.0));
+    }
+
+    if (index_.size() == capacity_) {
+      thin();
+    }
+
+    index_.push_back({Base::position_, offset_, Base::engine_});
+  }
+
+  // Drops every other entry and doubles K
+  void thin() {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < index_.size(); i += 2) {
+      index_[size++] = std::move(index_[i]);
+    }
+    index_.resize(size);
+    stride_ *= 2;
+  }
+
+  std::vector<Entry> index_;
+  std::int64_t offset_ = 0;
+  std::size_t replay_draws_ = default_replay_draws;
+  std::size_t capacity_ = default_capacity;
+  std::size_t base_interval_ = default_replay_draws;
+  std::size_t stride_ = 1;
+};
+
+} // namespace reverse
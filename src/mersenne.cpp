@@ -1,6 +1,7 @@
 #include "mersenne.h"
 
 #include <ios>
+#include <stdexcept>
 
 namespace reverse {
 
@@ -42,6 +43,27 @@ ReversibleMersenne::result_type ReversibleMersenne::previous() {
   return temper(state_[--pos_]);
 }
 
+std::byte* ReversibleMersenne::save(std::byte* out) const {
+  for (const auto& state: state_) {
+    out = util::store(out, state);
+  }
+  return util::store(out, std::uint32_t(pos_));
+}
+
+const std::byte* ReversibleMersenne::load(const std::byte* in) {
+  for (auto& state: state_) {
+    in = util::fetch(in, state);
+  }
+
+  std::uint32_t pos;
+  in = util::fetch(in, pos);
+  if (pos > state_size) {
+    throw std::runtime_error("Invalid Mersenne Twister state position.");
+  }
+  pos_ = int(pos);
+  return in;
+}
+
 std::ostream& operator<<(std::ostream& os, const ReversibleMersenne& rng) {
   const auto flags = os.flags(std::ios_base::dec | std::ios_base::fixed | std::ios_base::left);
   const auto space = os.widen(' ');
@@ -5,12 +5,15 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <limits>
 #include <ostream>
 #include <type_traits>
 
+#include "binary.h"
+
 namespace reverse {
 
 class ReversibleMersenne {
@@ -41,6 +44,17 @@ class ReversibleMersenne {
   result_type next();
   result_type previous();
 
+  // Size of the binary form (see `save`) in bytes, the state words followed by
+  // the position within the state
+  static constexpr std::size_t binary_size = 312 * sizeof(result_type) + sizeof(std::uint32_t);
+
+  // Writes the state in little-endian byte order and returns the end of the
+  // written bytes
+  std::byte* save(std::byte* out) const;
+
+  // Reads the state written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in);
+
   friend bool operator==(const ReversibleMersenne& lhs, const ReversibleMersenne& rhs) {
     return lhs.state_ == rhs.state_ && lhs.pos_ == rhs.pos_;
   }
@@ -0,0 +1,114 @@
+#include "mmap.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define REVERSE_HAS_MMAP 1
+#endif
+
+namespace reverse {
+
+#ifdef REVERSE_HAS_MMAP
+
+static std::runtime_error error(const char* what, const std::string& path, int code) {
+  return std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(code));
+}
+
+// Returns the error of a failed call on an open file, and closes the file.
+// The error code is read first, since closing may overwrite it.
+static std::runtime_error close_error(int fd, const char* what, const std::string& path) {
+  const int code = errno;
+  ::close(fd);
+  return error(what, path, code);
+}
+
+MappedFile::MappedFile(const std::string& path, std::size_t size) {
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    const int code = errno;
+    throw error("Cannot open", path, code);
+  }
+
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    throw close_error(fd, "Cannot stat", path);
+  }
+
+  if (size > std::size_t(status.st_size)) {
+    if (::ftruncate(fd, off_t(size)) != 0) {
+      throw close_error(fd, "Cannot resize", path);
+    }
+  } else {
+    size = std::size_t(status.st_size);
+  }
+
+  if (size != 0) {
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      throw close_error(fd, "Cannot map", path);
+    }
+    data_ = static_cast<std::byte*>(data);
+    size_ = size;
+  }
+
+  // The mapping holds its own reference to the file
+  ::close(fd);
+}
+
+void MappedFile::sync(std::size_t offset, std::size_t length) {
+  if (offset > size_ || length > size_ - offset) {
+    throw std::out_of_range("Synced range is outside of the mapping.");
+  }
+  if (length == 0) {
+    return;
+  }
+
+  // msync requires a page-aligned address
+  const std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+  const std::size_t start = offset / page * page;
+  if (::msync(data_ + start, offset + length - start, MS_SYNC) != 0) {
+    throw std::runtime_error(std::string("Cannot sync mapping: ") + std::strerror(errno));
+  }
+}
+
+void MappedFile::unmap() {
+  if (data_ != nullptr) {
+    ::munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string&, std::size_t) {
+  throw std::runtime_error("Memory mapped files are not supported on this platform.");
+}
+
+void MappedFile::sync(std::size_t, std::size_t) {}
+
+void MappedFile::unmap() {}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+} // namespace reverse
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include "reverse.h"
+
+namespace reverse {
+
+/// Read-write shared memory mapping of a whole file (POSIX `mmap`). Writes to
+/// the mapping reach the file through the page cache, and `sync` blocks until
+/// a range of it is written to storage. Throws std::runtime_error on platforms
+/// without `mmap`.
+class MappedFile {
+ public:
+  MappedFile() = default;
+
+  // Opens or creates the file at `path` and maps it. The file is extended to
+  // `size` bytes if it is shorter, otherwise its current size is mapped.
+  explicit MappedFile(const std::string& path, std::size_t size = 0);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  ~MappedFile();
+
+  std::byte* data() { return data_; }
+  const std::byte* data() const { return data_; }
+
+  // Returns the size of the mapping in bytes
+  std::size_t size() const { return size_; }
+
+  // Writes the given byte range of the mapping to storage and waits until it
+  // is written
+  void sync(std::size_t offset, std::size_t length);
+
+  void sync() { sync(0, size_); }
+ private:
+  void unmap();
+
+  std::byte* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/// Store of the states of many generators (e.g. one per agent) in a file of
+/// fixed-size records, which is mapped into memory. A record is the binary
+/// form of a generator (see `ReversibleRNG::save`) i.e. the engine state,
+/// distribution parameters and position. Records are only read when a
+/// generator is loaded by its index and are written back in place, so a
+/// large population can be suspended and resumed without deserializing every
+/// generator. `commit` writes the stored records to storage (`msync`).
+template <typename RNG = UniformRNG<>>
+class SnapshotStore {
+ public:
+  using rng_type = RNG;
+
+  static constexpr std::size_t record_size = RNG::binary_size;
+
+  // Opens or creates the store at `path` with at least `count` records. An
+  // existing store keeps its records, and its size must be a whole number of
+  // records of this generator type.
+  explicit SnapshotStore(const std::string& path, std::size_t count = 0)
+      : file_(path, count * record_size) {
+    if (file_.size() % record_size != 0) {
+      throw std::runtime_error("Snapshot file is not a whole number of generator records.");
+    }
+  }
+
+  // Returns the number of records
+  std::size_t size() const { return file_.size() / record_size; }
+
+  // Returns the generator of the given record
+  RNG get(std::size_t index) const {
+    RNG rng(defer_seed);
+    get(index, rng);
+    return rng;
+  }
+
+  // Loads the generator of the given record into `rng`
+  void get(std::size_t index, RNG& rng) const { rng.load(file_.data() + offset(index)); }
+
+  // Writes a generator to the given record
+  void put(std::size_t index, const RNG& rng) {
+    rng.save(file_.data() + offset(index));
+  }
+
+  // Writes the given range of records to storage
+  void commit(std::size_t first, std::size_t count) {
+    if (first > size() || count > size() - first) {
+      throw std::out_of_range("Snapshot records are out of range.");
+    }
+    file_.sync(first * record_size, count * record_size);
+  }
+
+  // Writes all records to storage
+  void commit() { file_.sync(); }
+ private:
+  // Returns the byte offset of the given record
+  std::size_t offset(std::size_t index) const {
+    if (index >= size()) {
+      throw std::out_of_range("Snapshot record is out of range.");
+    }
+    return index * record_size;
+  }
+
+  MappedFile file_;
+};
+
+} // namespace reverse
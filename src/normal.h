@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <ios>
 #include <istream>
@@ -9,6 +10,7 @@
 #include <ostream>
 #include <type_traits>
 
+#include "binary.h"
 #include "uniform.h"
 #include "xoshiro.h"
 
@@ -48,6 +50,20 @@ class NormalDistribution  {
     return ziggurat(urng) * stddev() + mean();
   }
 
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = 2 * sizeof(result_type);
+
+  // Writes the parameters in little-endian byte order and returns the end of
+  // the written bytes
+  std::byte* save(std::byte* out) const {
+    return util::store(util::store(out, mean_), stddev_);
+  }
+
+  // Reads the parameters written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) {
+    return util::fetch(util::fetch(in, mean_), stddev_);
+  }
+
   friend bool operator==(const NormalDistribution& lhs, const NormalDistribution& rhs) {
     return lhs.mean() == rhs.mean() && lhs.stddev() == rhs.stddev();
   }
@@ -0,0 +1 @@
+#include "partition.h"
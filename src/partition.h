@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "reverse.h"
+
+namespace reverse {
+
+// Default number of engine draws in the block of a rank (2^40)
+constexpr inline std::uint64_t default_block_length = std::uint64_t(1) << 40;
+
+/// Partitions the engine sequence of a globally seeded generator into disjoint
+/// blocks of `block_length` draws for multi-process runs e.g. one process per
+/// NUMA node. Rank r owns the draws [r * L, (r + 1) * L). Its generator starts
+/// at position zero at the start of its block, which the engine jumps to in
+/// logarithmic time. Hence, the generators of different ranks do not overlap
+/// while each consumes at most `block_length` draws, every rank reverses (and
+/// rolls back) on its own, and the block of a rank does not depend on the
+/// number of ranks.
+template <typename RNG = UniformRNG<>>
+RNG rank_rng(std::uint64_t seed, std::uint64_t rank, std::uint64_t world_size,
+             std::uint64_t block_length = default_block_length) {
+  static_assert(util::has_advance<typename RNG::engine_type>::value,
+      "Engine must be able to jump ahead");
+
+  if (rank >= world_size || block_length == 0) {
+    throw std::invalid_argument("Rank must be less than the world size and blocks non-empty.");
+  }
+  if (world_size > std::uint64_t(std::numeric_limits<std::int64_t>::max()) / block_length) {
+    throw std::invalid_argument("Blocks of all ranks must fit in 2^63 draws.");
+  }
+
+  const RNG master(Seed{seed});
+  return master.ahead(std::int64_t(rank * block_length));
+}
+
+} // namespace reverse
@@ -0,0 +1 @@
+#include "paths.h"
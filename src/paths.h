@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "reverse.h"
+
+namespace reverse {
+
+// Returns the generator of the given Monte Carlo path, which is the path's
+// substream of the master generator (see ReversibleRNG::split). Any path can
+// be re-run or rewound on its own with this generator.
+template <typename RNG>
+RNG path_rng(const RNG& master, std::size_t path) {
+  return master.split(path);
+}
+
+/// Runs `kernel(path, rng)` for every path in [0, n_paths) on a work-stealing
+/// pool of threads, where `rng` is the generator of the path (see `path_rng`).
+/// Every worker starts with a contiguous range of paths. A worker without
+/// paths steals the upper half of the remaining range of another worker.
+/// Since each path only depends on its own substream, the results are
+/// identical for any number of threads. The first exception thrown by a
+/// kernel stops the pool and is rethrown.
+template <typename RNG, typename Kernel>
+void parallel_for_paths(const RNG& master, std::size_t n_paths, Kernel&& kernel,
+                        Parallel policy = {}) {
+  const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t threads = std::min<std::size_t>(
+      policy.threads ? policy.threads : hardware, n_paths);
+  if (threads <= 1) {
+    for (std::size_t path = 0; path < n_paths; ++path) {
+      RNG rng = path_rng(master, path);
+      kernel(path, rng);
+    }
+    return;
+  }
+
+  struct alignas(64) Range {
+    std::mutex mutex;
+    std::size_t begin = 0, end = 0;
+  };
+
+  std::vector<Range> ranges(threads);
+  for (std::size_t t = 0; t < threads; ++t) {
+    ranges[t].begin = n_paths * t / threads;
+    ranges[t].end = n_paths * (t + 1) / threads;
+  }
+
+  std::atomic<bool> failed = false;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  // Moves the upper half of another worker's range to worker `t`
+  const auto steal = [&](std::size_t t) {
+    for (std::size_t i = 1; i < threads; ++i) {
+      Range& victim = ranges[(t + i) % threads];
+      std::size_t begin, end;
+      {
+        std::lock_guard lock(victim.mutex);
+        if (victim.begin == victim.end) {
+          continue;
+        }
+        begin = victim.end - (victim.end - victim.begin + 1) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+
+      std::lock_guard lock(ranges[t].mutex);
+      ranges[t].begin = begin;
+      ranges[t].end = end;
+      return true;
+    }
+    return false;
+  };
+
+  const auto work = [&](std::size_t t) {
+    while (!failed.load(std::memory_order_relaxed)) {
+      std::size_t path;
+      {
+        std::lock_guard lock(ranges[t].mutex);
+        path = ranges[t].begin < ranges[t].end ? ranges[t].begin++ : n_paths;
+      }
+      if (path == n_paths) {
+        if (steal(t)) {
+          continue;
+        }
+        return;
+      }
+
+      try {
+        RNG rng = path_rng(master, path);
+        kernel(path, rng);
+      } catch (...) {
+        std::lock_guard lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (std::size_t t = 1; t < threads; ++t) {
+    workers.emplace_back(work, t);
+  }
+  work(0);
+  for (auto& worker: workers) {
+    worker.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace reverse
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
+#include "binary.h"
+#include "xoshiro.h"
+
 #include "pcg_random.hpp"
 
 namespace reverse {
@@ -38,6 +42,32 @@ class ReversiblePCG : public EngineType {
   // Inherit constructors
   using EngineType::EngineType;
 
+  // Size of the binary form (see `save`) in bytes. The LCG state is followed by
+  // the stream for configurations with selectable streams.
+  static constexpr std::size_t binary_size =
+      (EngineType::can_specify_stream ? 2 : 1) * sizeof(typename EngineType::state_type);
+
+  // Writes the engine in little-endian byte order and returns the end of the
+  // written bytes
+  std::byte* save(std::byte* out) const {
+    out = util::store(out, EngineType::state_);
+    if constexpr (EngineType::can_specify_stream) {
+      out = util::store(out, EngineType::stream());
+    }
+    return out;
+  }
+
+  // Reads an engine written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) {
+    in = util::fetch(in, EngineType::state_);
+    if constexpr (EngineType::can_specify_stream) {
+      state_type stream;
+      in = util::fetch(in, stream);
+      EngineType::set_stream(stream);
+    }
+    return in;
+  }
+
   // Equivalent to `(*this)()`
   result_type next() { return EngineType::operator()(); }
 
@@ -49,6 +79,33 @@ class ReversiblePCG : public EngineType {
 
     return EngineType::output(base_ungenerate());
   }
+
+  // Returns a copy of the engine on the `i`th substream. For configurations
+  // with selectable streams, the LCG increment is a hash of the current
+  // increment XOR `i`. Sibling substreams thus have distinct increments (for
+  // ids below 2^(bits - 1)) and never share their sequence of states. The
+  // state is reseeded from a Splitmix64 hash of the state, the stream and `i`,
+  // so that siblings do not start with the same output. Nested substreams and
+  // configurations without selectable streams (e.g. pcg64_fast) only rely on
+  // the hash: their streams differ with high probability, but may overlap by
+  // chance (about n * k^2 / 2^bits for k streams of n values each).
+  ReversiblePCG substream(std::uint64_t i) const {
+    std::uint64_t key = absorb(Splitmix64::mix(i), EngineType::state_);
+    if constexpr (EngineType::can_specify_stream) {
+      key = absorb(key, EngineType::stream());
+    }
+
+    Splitmix64 mix(key);
+    ReversiblePCG engine;
+    const state_type state = squeeze(mix);
+    if constexpr (EngineType::can_specify_stream) {
+      Splitmix64 streams(absorb(0, EngineType::stream()));
+      engine.seed(state, squeeze(streams) ^ state_type(i));
+    } else {
+      engine.seed(state);
+    }
+    return engine;
+  }
  protected:
   using typename EngineType::state_type;
 
@@ -69,6 +126,29 @@ class ReversiblePCG : public EngineType {
   state_type base_ungenerate0() {
     return EngineType::state_ = unbump(EngineType::state_);
   }
+
+  // Mixes the 64-bit words of a state value into a key
+  static std::uint64_t absorb(std::uint64_t key, state_type value) {
+    for (std::size_t word = 0; word < sizeof(state_type); word += sizeof(std::uint64_t)) {
+      key = Splitmix64::mix(key ^ std::uint64_t(value));
+      if constexpr (sizeof(state_type) > sizeof(std::uint64_t)) {
+        value >>= 64;
+      }
+    }
+    return key;
+  }
+
+  // Returns a state value from the next outputs of a Splitmix64 generator
+  static state_type squeeze(Splitmix64& mix) {
+    state_type value = 0;
+    for (std::size_t word = 0; word < sizeof(state_type); word += sizeof(std::uint64_t)) {
+      if constexpr (sizeof(state_type) > sizeof(std::uint64_t)) {
+        value <<= 64;
+      }
+      value |= state_type(mix());
+    }
+    return value;
+  }
  private:
   template <typename T>
   struct ExtractPCG;
@@ -0,0 +1 @@
+#include "prefetch.h"
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "pcg.h"
+#include "reverse.h"
+#include "ring.h"
+
+namespace reverse {
+
+/// Reversible random number generator whose values are computed ahead of time
+/// by a helper thread. The helper fills a lock-free SPSC queue with up to
+/// `Capacity` values in the current direction. The consumer keeps the most
+/// recent `Capacity` values in a window, which serves `previous` (and the
+/// following `next` calls) without touching the engine. When the consumer
+/// leaves the window in the other direction, the helper is repositioned and
+/// fills the queue in that direction. Values in the queue are tagged with the
+/// epoch of their request, and stale values are dropped by the consumer.
+/// While the queue is full, the helper sleeps on a condition variable until
+/// the consumer pops a value, or the helper is redirected or stopped.
+///
+/// The sequence is identical to a ReversibleRNG with the same seed. Seeding
+/// restarts the helper thread.
+template <typename DistType = UniformDistribution<>,
+          typename EngineType = ReversiblePCG<>,
+          std::size_t Capacity = 1024>
+class PrefetchingReversibleRNG {
+  using RNG = ReversibleRNG<DistType, EngineType>;
+ public:
+  using result_type = typename RNG::result_type;
+
+  template <typename... Args, typename = typename
+      std::enable_if<std::is_constructible<RNG, Args&&...>::value>::type>
+  explicit PrefetchingReversibleRNG(Args&&... args)
+      : rng_(std::forward<Args>(args)...), queue_(Capacity), window_(Capacity) {
+    start();
+  }
+
+  PrefetchingReversibleRNG(const PrefetchingReversibleRNG&) = delete;
+  PrefetchingReversibleRNG& operator=(const PrefetchingReversibleRNG&) = delete;
+
+  ~PrefetchingReversibleRNG() { stop(); }
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    stop();
+    rng_.seed(std::forward<Args>(params)...);
+    start();
+  }
+
+  result_type min() const { return rng_.min(); }
+  result_type max() const { return rng_.max(); }
+
+  result_type operator()() { return next(); }
+
+  // Returns the next random value
+  result_type next() {
+    const std::int64_t end = start_ + std::int64_t(window_.size());
+    if (position_ < end) {
+      return window_[position_++ - start_];
+    }
+
+    if (!forward_) {
+      request(end, true);
+    }
+    const result_type value = pop();
+    if (window_.full()) {
+      start_++;
+    }
+    window_.push_back(value);
+    position_++;
+    return value;
+  }
+
+  // Returns the previous random value
+  result_type previous() {
+    if (position_ > start_) {
+      return window_[--position_ - start_];
+    }
+
+    if (forward_) {
+      request(start_, false);
+    }
+    const result_type value = pop();
+    window_.push_front(value);
+    start_--;
+    position_--;
+    return value;
+  }
+
+  // Returns the position on the random number sequence
+  std::int64_t position() const { return position_; }
+ private:
+  struct Item {
+    std::uint64_t epoch;
+    result_type value;
+  };
+
+  struct Request {
+    std::uint64_t epoch;
+    std::int64_t position;
+    bool forward;
+  };
+
+  void start() {
+    position_ = start_ = rng_.position();
+    window_.clear();
+    queue_.clear();
+    request_ = {0, rng_.position(), true};
+    requested_ = epoch_ = 0;
+    forward_ = true;
+    stop_ = false;
+    thread_ = std::thread([this] { produce(); });
+  }
+
+  void stop() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    room_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  // Asks the helper thread to generate in the given direction from `position`
+  void request(std::int64_t position, bool forward) {
+    forward_ = forward;
+    {
+      std::lock_guard lock(mutex_);
+      request_ = {++epoch_, position, forward};
+      requested_.store(epoch_, std::memory_order_release);
+    }
+    room_.notify_one();
+  }
+
+  // Returns the next value of the current request from the queue
+  result_type pop() {
+    Item item;
+    while (true) {
+      if (!queue_.pop(item)) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // Wakes the helper if it waits for room. The fences order the pop before
+      // the flag check, and the flag before the helper's last push attempt.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting_.load(std::memory_order_relaxed)) {
+        std::lock_guard lock(mutex_);
+        room_.notify_one();
+      }
+      if (item.epoch == epoch_) {
+        return item.value;
+      }
+    }
+  }
+
+  // Helper thread loop
+  void produce() {
+    Request request = request_;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      if (requested_.load(std::memory_order_acquire) != request.epoch) {
+        {
+          std::lock_guard lock(mutex_);
+          request = request_;
+        }
+        rng_.seek(request.position);
+      }
+
+      push({request.epoch, request.forward ? rng_.next() : rng_.previous()});
+    }
+  }
+
+  // Pushes a value onto the queue. Sleeps while the queue is full, unless the
+  // helper is stopped or its request is replaced (and the value is stale).
+  void push(const Item& item) {
+    if (queue_.push(item)) {
+      return;
+    }
+
+    std::unique_lock lock(mutex_);
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    room_.wait(lock, [&] {
+      return stop_.load(std::memory_order_relaxed)
+          || requested_.load(std::memory_order_relaxed) != item.epoch || queue_.push(item);
+    });
+    waiting_.store(false, std::memory_order_relaxed);
+  }
+
+  // Owned by the helper thread while it runs
+  RNG rng_;
+  SpscQueue<Item> queue_;
+
+  std::mutex mutex_;
+  std::condition_variable room_;
+  Request request_;
+  std::atomic<std::uint64_t> requested_ = 0;
+  std::atomic<bool> stop_ = false;
+  std::atomic<bool> waiting_ = false;
+  std::thread thread_;
+
+  // Consumer state: window of values at positions [start_, start_ + size)
+  RingBuffer<result_type> window_;
+  std::int64_t position_ = 0;
+  std::int64_t start_ = 0;
+  std::uint64_t epoch_ = 0;
+  bool forward_ = true;
+};
+
+} // namespace reverse
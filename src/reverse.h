@@ -1,15 +1,23 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <ios>
 #include <istream>
+#include <limits>
 #include <ostream>
 #include <random>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "binary.h"
 #include "exponential.h"
 #include "normal.h"
 #include "pcg.h"
@@ -19,6 +27,115 @@
 
 namespace reverse {
 
+namespace util {
+
+template <typename RURNG, typename = void>
+struct has_advance : std::false_type {};
+
+template <typename RURNG>
+struct has_advance<RURNG, std::void_t<decltype(std::declval<RURNG&>().advance(0))>>
+    : std::true_type {};
+
+// Moves a reversible uniform random number generator (RURNG) by `delta` draws,
+// backwards if negative. Uses the logarithmic time `advance` and `backstep`
+// functions of the RURNG if available e.g. ReversiblePCG.
+template <typename RURNG>
+inline void advance(RURNG& rurng, std::int64_t delta) {
+  if constexpr (has_advance<RURNG>::value) {
+    if (delta >= 0) {
+      rurng.advance(std::uint64_t(delta));
+    } else {
+      rurng.backstep(std::uint64_t(-delta));
+    }
+  } else {
+    for (; delta > 0; --delta) {
+      rurng();
+    }
+    for (; delta < 0; ++delta) {
+      rurng.previous();
+    }
+  }
+}
+
+} // namespace util
+
+/// Number of engine draws that a distribution consumes for every value, or
+/// zero if the number varies e.g. with rejection sampling. A fixed number of
+/// draws allows for jumping the engine instead of stepping through values.
+template <typename DistType, typename EngineType>
+struct DrawsPerValue : std::integral_constant<std::size_t, 0> {};
+
+template <typename RealType, typename EngineType>
+struct DrawsPerValue<UniformRealDistribution<RealType>, EngineType>
+    : std::integral_constant<std::size_t, 1> {};
+
+template <typename RealType, typename EngineType>
+struct DrawsPerValue<ExponentialDistribution<RealType>, EngineType>
+    : std::integral_constant<std::size_t, 1> {};
+
+/// Distribution that produces several values from a single 64-bit engine draw,
+/// e.g. two float values from the high and low halves. The distribution must
+/// have a static `values_per_draw` and a `block(bits)` function that returns
+/// the values of one draw. This changes the sequence of the distribution, so
+/// generators opt in with e.g. ReversibleRNG<Blocked<UniformDistribution<float>>>.
+template <typename DistType>
+class Blocked : public DistType {
+ public:
+  using DistType::DistType;
+
+  // Number of values per engine draw
+  static constexpr std::size_t block_size = DistType::values_per_draw;
+};
+
+template <typename DistType, typename EngineType>
+struct DrawsPerValue<Blocked<DistType>, EngineType> : DrawsPerValue<DistType, EngineType> {};
+
+/// Number of values that a distribution produces from a single engine draw,
+/// which is the static `block_size` of the distribution (see Blocked). Engines
+/// with less than 64 bits of output always produce one value per draw.
+template <typename DistType, typename EngineType, typename = void>
+struct BlockSize : std::integral_constant<std::size_t, 1> {};
+
+template <typename DistType, typename EngineType>
+struct BlockSize<DistType, EngineType, std::void_t<decltype(DistType::block_size)>>
+    : std::integral_constant<std::size_t,
+        util::range<EngineType>() == std::numeric_limits<std::uint64_t>::max()
+            ? DistType::block_size : 1> {};
+
+/// Whether a distribution accepts or rejects every engine draw independently
+/// of the preceding draws, and each value only depends on its accepting draw
+/// e.g. the ziggurat and Lemire's method. The values of any range of draws can
+/// then be generated without knowing where the preceding value ended, in both
+/// directions.
+template <typename DistType, typename EngineType>
+struct DrawLocal : std::false_type {};
+
+template <typename RealType, typename EngineType>
+struct DrawLocal<NormalDistribution<RealType>, EngineType> : std::true_type {};
+
+template <typename IntType, typename EngineType>
+struct DrawLocal<UniformIntDistribution<IntType>, EngineType>
+    : std::integral_constant<bool,
+        util::range<EngineType>() == std::numeric_limits<std::uint64_t>::max()> {};
+
+/// Tag for constructing a generator without seeding it from
+/// `std::random_device` (a system call), e.g. when it is reseeded right away.
+/// The engine then has its default seed.
+struct DeferSeed {};
+inline constexpr DeferSeed defer_seed{};
+
+/// Seed value of a generator, which avoids ambiguity with the distribution
+/// parameters of the constructor e.g. `NormalRNG<> rng(Seed{42}, 0.0, 2.0);`.
+struct Seed {
+  std::uint64_t value;
+};
+
+/// Execution policy for the parallel `next`/`previous` functions of
+/// ReversibleRNG. Zero threads uses the hardware concurrency.
+struct Parallel {
+  unsigned threads = 0;
+};
+
 /// Wrapper class that changes the direction of a reversible uniform random
 /// number generator (RURNG) e.g. ReversiblePCG. Replaces the function-call
 /// operator with the RURNG's `previous` function. Conforms to minimum named
@@ -34,20 +151,95 @@ class ReversedEngine {
   static constexpr result_type max() { return RURNG::max(); }
 
   result_type operator()() { return engine_.previous(); }
+
+  // Returns the underlying (forward) RURNG
+  RURNG& engine() const { return engine_; }
  private:
   RURNG& engine_;
 };
 
+/// Wrapper class that counts the number of calls to the function-call operator
+/// of a uniform random bit generator. Used to measure how many engine draws a
+/// distribution consumes per value. Conforms to minimum named requirements to
+/// be a `UniformRandomBitGenerator`.
+template <typename URNG>
+class CountingEngine {
+ public:
+  using result_type = typename URNG::result_type;
+
+  CountingEngine(URNG& urng) : engine_(urng) {}
+
+  static constexpr result_type min() { return URNG::min(); }
+  static constexpr result_type max() { return URNG::max(); }
+
+  result_type operator()() {
+    count_++;
+    return engine_();
+  }
+
+  // Returns the number of draws made through this wrapper
+  std::uint64_t count() const { return count_; }
+ private:
+  URNG& engine_;
+  std::uint64_t count_ = 0;
+};
+
+/// Buffered draw (block) of a distribution with several values per engine
+/// draw, and the engine position in draws. Empty for distributions with one
+/// value per draw, which then do not pay for the buffer.
+template <typename ResultType, std::size_t BlockSize>
+class BlockBuffer {
+ protected:
+  static constexpr std::int64_t no_block = std::numeric_limits<std::int64_t>::min();
+
+  // Drops the buffered draw and moves to the first draw
+  void reset_block() {
+    first_ = no_block;
+    draw_ = 0;
+  }
+
+  // Returns the index of the given position in the buffered draw, which is at
+  // least BlockSize if the position is not buffered
+  std::uint64_t buffered(std::int64_t position) const {
+    return std::uint64_t(position) - std::uint64_t(first_);
+  }
+
+  std::array<ResultType, BlockSize> values_{};
+  // Position of the first buffered value
+  std::int64_t first_ = no_block;
+  std::int64_t draw_ = 0;
+};
+
+template <typename ResultType>
+class BlockBuffer<ResultType, 1> {
+ protected:
+  void reset_block() {}
+};
+
 /// Main templated class for defining a reversible random number generator on a
 /// given probability distribution. The underlying reversible generator is
 /// randomly seeded with seed sequence.
+///
+/// Distributions with several values per engine draw (see BlockSize) are
+/// buffered. The values at positions [k * B, (k + 1) * B) come from the kth
+/// draw, which is read forwards or backwards depending on the direction. Hence,
+/// the sequence is the same in both directions, and the engine position is
+/// tracked separately from the value position.
 template <typename DistType = UniformDistribution<>,
           typename EngineType = ReversiblePCG<>>
-class ReversibleRNG {
+class ReversibleRNG : protected BlockBuffer<typename DistType::result_type,
+                                             BlockSize<DistType, EngineType>::value> {
+  using Buffer = BlockBuffer<typename DistType::result_type, BlockSize<DistType, EngineType>::value>;
  public:
   using result_type = typename DistType::result_type;
+  using distribution_type = DistType;
+  using engine_type = EngineType;
 
-  template <typename... Args>
+  // Number of values per engine draw
+  static constexpr std::size_t block_size = BlockSize<DistType, EngineType>::value;
+
+  template <typename... Args, typename = typename
+      std::enable_if<std::is_constructible<DistType, Args&&...>::value>::type>
   ReversibleRNG(Args&&... args)
       : distribution_(std::forward<Args>(args)...) {
     // Randomly seed from a non-deterministic source if available e.g. /dev/random
@@ -55,11 +247,33 @@ class ReversibleRNG {
     seed(seed_source);
   }
 
+  // Constructs a generator with the default seed of the engine
+  template <typename... Args>
+  explicit ReversibleRNG(DeferSeed, Args&&... args)
+      : distribution_(std::forward<Args>(args)...) {}
+
+  // Constructs a generator with the given seed
+  template <typename... Args>
+  explicit ReversibleRNG(Seed sd, Args&&... args)
+      : distribution_(std::forward<Args>(args)...) {
+    seed(sd.value);
+  }
+
+  // Constructs the child with the given id of a master generator (see
+  // `child_seed`). Children of the same master are seeded differently.
+  template <typename MasterDist, typename MasterEngine, typename... Args>
+  ReversibleRNG(const ReversibleRNG<MasterDist, MasterEngine>& master, std::uint64_t id,
+                Args&&... args)
+      : distribution_(std::forward<Args>(args)...) {
+    seed(master.child_seed(id));
+  }
+
   template <typename... Args>
   void seed(Args&&... params) {
     engine_.seed(std::forward<Args>(params)...);
     distribution_.reset();
     position_ = 0;
+    this->reset_block();
   }
 
   result_type min() const { return distribution_.min(); }
@@ -75,31 +289,72 @@ class ReversibleRNG {
 
   // Returns the next random value
   result_type next() {
-    position_++;
-    return distribution_(engine_);
+    if constexpr (block_size > 1) {
+      const std::uint64_t i = this->buffered(position_);
+      if (i < block_size) {
+        position_++;
+        return this->values_[i];
+      }
+      return blocked(position_++);
+    } else {
+      position_++;
+      return distribution_(engine_);
+    }
   }
 
   // Returns the previous random value
   result_type previous() {
-    position_--;
-    ReversedEngine reversed(engine_);
-    return distribution_(reversed);
+    if constexpr (block_size > 1) {
+      const std::uint64_t i = this->buffered(--position_);
+      if (i < block_size) {
+        return this->values_[i];
+      }
+      return blocked(position_);
+    } else {
+      position_--;
+      ReversedEngine reversed(engine_);
+      return distribution_(reversed);
+    }
   }
 
   // Returns a vector of the next random values
   std::vector<result_type> next(std::size_t N) {
     std::vector<result_type> values(N);
-    std::generate(values.begin(), values.end(), [&] { return next(); });
+    if constexpr (block_size > 1) {
+      fill_forward(values.data(), N);
+    } else {
+      std::generate(values.begin(), values.end(), [&] { return next(); });
+    }
     return values;
   }
 
   // Returns a vector of the previous random values
   std::vector<result_type> previous(std::size_t N) {
     std::vector<result_type> values(N);
-    std::generate(values.rbegin(), values.rend(), [&] { return previous(); });
+    if constexpr (block_size > 1) {
+      fill_backward(values.data(), N);
+    } else {
+      std::generate(values.rbegin(), values.rend(), [&] { return previous(); });
+    }
     return values;
   }
 
+  // Returns a vector of the next random values generated by multiple threads.
+  // The values and the final state are identical to the serial function. Each
+  // thread jumps a copy of the engine to its block of the sequence, which
+  // requires an engine with an `advance` function and a distribution with a
+  // fixed number of draws (or draw-local rejection, see DrawLocal). Otherwise,
+  // the values are generated serially.
+  std::vector<result_type> next(std::size_t N, Parallel policy) {
+    return parallel(N, policy, true);
+  }
+
+  // Returns a vector of the previous random values generated by multiple
+  // threads (see above)
+  std::vector<result_type> previous(std::size_t N, Parallel policy) {
+    return parallel(N, policy, false);
+  }
+
   // Returns a tuple of the next random values
   template <std::size_t N>
   auto next() {
@@ -112,12 +367,120 @@ class ReversibleRNG {
     return get(std::make_index_sequence<N>{}, previous(N));
   }
 
+  // Moves to the given position on the random number sequence. Jumps the
+  // engine if the distribution has a fixed number of draws per value (in
+  // logarithmic time for engines with an `advance` function), otherwise steps
+  // through the values in between. Buffered distributions jump on the next
+  // value.
+  void seek(std::int64_t position) {
+    constexpr std::int64_t draws = DrawsPerValue<DistType, EngineType>::value;
+    if constexpr (block_size > 1) {
+      position_ = position;
+    } else if constexpr (draws != 0) {
+      util::advance(engine_, (position - position_) * draws);
+      position_ = position;
+    } else {
+      while (position_ < position) {
+        next();
+      }
+      while (position_ > position) {
+        previous();
+      }
+    }
+  }
+
   // Returns the position on the random number sequence
   inline std::int64_t position() const { return position_; }
 
+  // Returns the seed of the child with the given id. The seeds of all children
+  // are a Splitmix64 sequence keyed by the next two engine outputs (see
+  // util::draw_key), and the sequence is jumped to the id in constant time.
+  std::uint64_t child_seed(std::uint64_t id) const {
+    EngineType engine(engine_);
+    Splitmix64 mix(util::draw_key(engine));
+    mix.discard(id);
+    return mix();
+  }
+
+  // Returns a generator at position zero whose engine is the given number of
+  // draws ahead of the current engine (in logarithmic time for engines with
+  // an `advance` function) e.g. a disjoint block of the engine sequence.
+  ReversibleRNG ahead(std::int64_t draws) const {
+    EngineType engine(engine_);
+    util::advance(engine, draws);
+    return restart(std::move(engine));
+  }
+
+  // Returns a generator at position zero on the given substream of the
+  // current engine (see util::substream) e.g. one per thread or task. Splits
+  // of splits differ from direct splits, and the guarantees against overlaps
+  // are those of the `substream` function of the engine.
+  ReversibleRNG split(std::uint64_t stream_id) const {
+    return restart(util::substream(engine_, stream_id));
+  }
+
+  // Version of the binary form, which is written first
+  static constexpr std::uint32_t binary_version = 1;
+
+  // Size of the binary form (see `save`) in bytes. Allows for preallocating
+  // snapshots of many generators.
+  static constexpr std::size_t binary_size = sizeof(binary_version) + EngineType::binary_size
+      + DistType::binary_size + (block_size > 1 ? 2 : 1) * sizeof(std::int64_t);
+
+  // Writes the version, engine, distribution and position in little-endian
+  // byte order, and returns the end of the written bytes
+  std::byte* save(std::byte* out) const {
+    out = util::store(out, binary_version);
+    out = distribution_.save(engine_.save(out));
+    out = util::store(out, position_);
+    if constexpr (block_size > 1) {
+      out = util::store(out, this->draw_);
+    }
+    return out;
+  }
+
+  // Reads a generator written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) {
+    std::uint32_t version;
+    in = util::fetch(in, version);
+    if (version != binary_version) {
+      throw std::runtime_error("Unsupported binary version of the generator.");
+    }
+
+    in = distribution_.load(engine_.load(in));
+    in = util::fetch(in, position_);
+    if constexpr (block_size > 1) {
+      in = util::fetch(in, this->draw_);
+      this->first_ = Buffer::no_block;
+    }
+    return in;
+  }
+
+#ifdef __cpp_lib_span
+  // Writes the binary form to the front of `out`, and returns the remaining bytes
+  std::span<std::byte> save(std::span<std::byte> out) const {
+    if (out.size() < binary_size) {
+      throw std::invalid_argument("Buffer is too small for the binary form of the generator.");
+    }
+    return out.subspan(save(out.data()) - out.data());
+  }
+
+  // Reads the binary form from the front of `in`, and returns the remaining bytes
+  std::span<const std::byte> load(std::span<const std::byte> in) {
+    if (in.size() < binary_size) {
+      throw std::invalid_argument("Buffer is too small for the binary form of the generator.");
+    }
+    return in.subspan(load(in.data()) - in.data());
+  }
+#endif
+
   friend bool operator==(const ReversibleRNG& lhs, const ReversibleRNG& rhs) {
-    return lhs.engine_ == rhs.engine_ && lhs.distribution_ == rhs.distribution_
+    bool equal = lhs.engine_ == rhs.engine_ && lhs.distribution_ == rhs.distribution_
         && lhs.position() == rhs.position();
+    if constexpr (block_size > 1) {
+      equal = equal && lhs.draw_ == rhs.draw_;
+    }
+    return equal;
   }
 
   friend std::ostream& operator<<(std::ostream& os, const ReversibleRNG& rng) {
@@ -126,6 +489,9 @@ class ReversibleRNG {
     const auto fill = os.fill(space);
 
     os << rng.engine_ << space << rng.distribution_ << space << rng.position();
+    if constexpr (block_size > 1) {
+      os << space << rng.draw_;
+    }
 
     os.flags(flags);
     os.fill(fill);
@@ -136,16 +502,241 @@ class ReversibleRNG {
     const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
 
     is >> rng.engine_ >> rng.distribution_ >> rng.position_;
+    if constexpr (block_size > 1) {
+      is >> rng.draw_;
+      rng.first_ = Buffer::no_block;
+    }
 
     is.flags(flags);
     return is;
   }
- private:
+ protected:
   template <std::size_t... Is, typename T>
   static auto get(std::index_sequence<Is...>, const std::vector<T>& values) {
     return std::make_tuple(values[Is]...);
   }
 
+  // Returns a copy of the generator at position zero on the given engine
+  ReversibleRNG restart(EngineType engine) const {
+    ReversibleRNG rng(*this);
+    rng.engine_ = std::move(engine);
+    rng.distribution_.reset();
+    rng.position_ = 0;
+    rng.reset_block();
+    return rng;
+  }
+
+  // Minimum number of values per thread of the parallel functions
+  static constexpr std::size_t parallel_chunk = 1 << 16;
+
+  std::vector<result_type> parallel(std::size_t N, Parallel policy, bool forward) {
+    constexpr bool fixed = block_size > 1 || DrawsPerValue<DistType, EngineType>::value != 0;
+    constexpr bool local = DrawLocal<DistType, EngineType>::value;
+
+    const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t threads = std::min<std::size_t>(
+        policy.threads ? policy.threads : hardware, N / parallel_chunk);
+    if constexpr (util::has_advance<EngineType>::value && (fixed || local)) {
+      if (threads > 1) {
+        std::vector<result_type> values(N);
+        if constexpr (fixed) {
+          parallel_fixed(values, threads, forward);
+        } else {
+          parallel_local(values, threads, forward);
+        }
+        return values;
+      }
+    }
+    return forward ? next(N) : previous(N);
+  }
+
+  // Runs `work(t)` for t in [0, threads) with one thread each
+  template <typename Work>
+  static void run(std::size_t threads, Work work) {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; ++t) {
+      workers.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker: workers) {
+      worker.join();
+    }
+  }
+
+  // Splits the values into blocks of positions. Each thread seeks a copy of
+  // the generator to its block.
+  void parallel_fixed(std::vector<result_type>& values, std::size_t threads, bool forward) {
+    const std::size_t N = values.size();
+    const std::size_t chunk = (N + threads - 1) / threads;
+    const std::int64_t start = forward ? position_ : position_ - std::int64_t(N);
+
+    run(threads, [&](std::size_t t) {
+      const std::size_t first = std::min(N, t * chunk), last = std::min(N, first + chunk);
+      ReversibleRNG worker(std::as_const(*this));
+      worker.seek(start + first);
+      for (std::size_t i = first; i < last; ++i) {
+        values[i] = worker.next();
+      }
+    });
+
+    // Leaves the engine where the serial function would
+    if constexpr (block_size > 1) {
+      if (forward) {
+        seek(start + N - 1);
+        next();
+      } else {
+        seek(start + 1);
+        previous();
+      }
+    } else {
+      seek(forward ? start + N : start);
+    }
+  }
+
+  // Splits the engine draws into blocks, which each thread parses into values
+  // (in the direction of generation). A value whose accepting draw lies past
+  // its block belongs to the next block, and is dropped. Repeats in rounds
+  // until N values are found.
+  void parallel_local(std::vector<result_type>& values, std::size_t threads, bool forward) {
+    const std::size_t N = values.size();
+    std::vector<std::vector<result_type>> blocks(threads);
+    std::vector<std::uint64_t> ends(threads);
+
+    // Draws to the start of the round, and to the end of the last value
+    std::uint64_t base = 0, end = 0;
+    std::size_t size = 0;
+    while (size < N) {
+      const std::size_t remaining = N - size;
+      const std::uint64_t chunk = (remaining + remaining / 8) / threads + 64;
+
+      run(threads, [&](std::size_t t) {
+        blocks[t].clear();
+        ends[t] = parse(base + t * chunk, chunk, forward, &blocks[t]);
+      });
+
+      for (std::size_t t = 0; t < threads && size < N; ++t) {
+        const std::size_t count = std::min(blocks[t].size(), N - size);
+        for (std::size_t i = 0; i < count; ++i, ++size) {
+          values[forward ? size : N - 1 - size] = blocks[t][i];
+        }
+        if (count != 0) {
+          const std::uint64_t offset = base + t * chunk;
+          end = offset + (count == blocks[t].size()
+              ? ends[t] : parse(offset, chunk, forward, nullptr, count));
+        }
+      }
+      base += threads * chunk;
+    }
+
+    util::advance(engine_, forward ? std::int64_t(end) : -std::int64_t(end));
+    position_ += forward ? std::int64_t(N) : -std::int64_t(N);
+  }
+
+  // Generates the values whose accepting draws lie in the `chunk` draws after
+  // (or before) `offset` draws, or at most `limit` values. Returns the number
+  // of draws from the start of the chunk to the end of the last value.
+  std::uint64_t parse(std::uint64_t offset, std::uint64_t chunk, bool forward,
+                      std::vector<result_type>* values,
+                      std::size_t limit = std::numeric_limits<std::size_t>::max()) {
+    EngineType engine = engine_;
+    util::advance(engine, forward ? std::int64_t(offset) : -std::int64_t(offset));
+    if (forward) {
+      return parse(engine, chunk, values, limit);
+    }
+    ReversedEngine reversed(engine);
+    return parse(reversed, chunk, values, limit);
+  }
+
+  template <typename URNG>
+  std::uint64_t parse(URNG& urng, std::uint64_t chunk, std::vector<result_type>* values,
+                      std::size_t limit) const {
+    DistType distribution = distribution_;
+    CountingEngine counter(urng);
+    std::uint64_t end = 0;
+    for (std::size_t n = 0; n < limit; ++n) {
+      const result_type value = distribution(counter);
+      if (counter.count() > chunk) {
+        break;
+      }
+      if (values) {
+        values->push_back(value);
+      }
+      end = counter.count();
+    }
+    return end;
+  }
+
+  // Buffers the draw of the given position of a buffered distribution, and
+  // returns the value at the position
+  result_type blocked(std::int64_t position) {
+    constexpr std::int64_t size = block_size;
+    const std::int64_t index = (position >= 0 ? position : position - size + 1) / size;
+    if (index < this->draw_) {
+      util::advance(engine_, index + 1 - this->draw_);
+      this->values_ = distribution_.block(engine_.previous());
+      this->draw_ = index;
+    } else {
+      util::advance(engine_, index - this->draw_);
+      this->values_ = distribution_.block(engine_());
+      this->draw_ = index + 1;
+    }
+    this->first_ = index * size;
+    return this->values_[position - this->first_];
+  }
+
+  // Writes the next N values of a buffered distribution. The values of whole
+  // draws are written straight to the output, and only the partial draws at
+  // either end go through the buffer.
+  void fill_forward(result_type* values, std::size_t N) {
+    constexpr std::int64_t size = block_size;
+    std::size_t i = 0;
+    for (; i < N && position_ % size != 0; ++i) {
+      values[i] = next();
+    }
+    if (N - i >= block_size) {
+      util::advance(engine_, position_ / size - this->draw_);
+      auto block = this->values_;
+      const std::size_t begin = i;
+      for (; N - i >= block_size; i += block_size) {
+        block = distribution_.block(engine_());
+        std::copy(block.begin(), block.end(), values + i);
+      }
+      position_ += std::int64_t(i - begin);
+      this->draw_ = position_ / size;
+      this->values_ = block;
+      this->first_ = position_ - size;
+    }
+    for (; i < N; ++i) {
+      values[i] = next();
+    }
+  }
+
+  // Writes the previous N values of a buffered distribution in the order of
+  // their positions (see `fill_forward`)
+  void fill_backward(result_type* values, std::size_t N) {
+    constexpr std::int64_t size = block_size;
+    std::size_t i = N;
+    for (; i > 0 && position_ % size != 0; --i) {
+      values[i - 1] = previous();
+    }
+    if (i >= block_size) {
+      util::advance(engine_, position_ / size - this->draw_);
+      auto block = this->values_;
+      const std::size_t end = i;
+      for (; i >= block_size; i -= block_size) {
+        block = distribution_.block(engine_.previous());
+        std::copy(block.begin(), block.end(), values + i - block_size);
+      }
+      position_ -= std::int64_t(end - i);
+      this->draw_ = position_ / size;
+      this->values_ = block;
+      this->first_ = position_;
+    }
+    for (; i > 0; --i) {
+      values[i - 1] = previous();
+    }
+  }
+
   EngineType engine_;
   DistType distribution_;
   std::int64_t position_ = 0;
@@ -163,4 +754,14 @@ using NormalRNG = ReversibleRNG<NormalDistribution<RealType>>;
 template <typename RealType = double>
 using ExponentialRNG = ReversibleRNG<ExponentialDistribution<RealType>>;
 
+// Returns the generator of the calling thread. Every thread gets its own
+// substream of a master generator, which is randomly seeded once.
+template <typename RNG = UniformRNG<>>
+RNG& thread_rng() {
+  static const RNG master;
+  static std::atomic<std::uint64_t> streams = 0;
+  thread_local RNG rng = master.split(streams.fetch_add(1, std::memory_order_relaxed));
+  return rng;
+}
+
 } // namespace reverse
@@ -0,0 +1 @@
+#include "ring.h"
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace reverse {
+
+/// Fixed capacity circular buffer that can grow and shrink at both ends. A push
+/// onto a full buffer drops the value at the opposite end. Used as a window of
+/// values around the position of a generator.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(std::size_t capacity) : buffer_(capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("Ring buffer capacity must be positive.");
+    }
+  }
+
+  std::size_t capacity() const { return buffer_.size(); }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == buffer_.size(); }
+
+  void clear() { first_ = size_ = 0; }
+
+  // Returns the `i`th value from the front
+  T& operator[](std::size_t i) { return buffer_[index(i)]; }
+  const T& operator[](std::size_t i) const { return buffer_[index(i)]; }
+
+  // Appends a value, dropping the front value if full
+  void push_back(const T& value) {
+    if (full()) {
+      pop_front();
+    }
+    buffer_[index(size_++)] = value;
+  }
+
+  // Prepends a value, dropping the back value if full
+  void push_front(const T& value) {
+    if (full()) {
+      pop_back();
+    }
+    first_ = first_ == 0 ? buffer_.size() - 1 : first_ - 1;
+    buffer_[first_] = value;
+    size_++;
+  }
+
+  void pop_front() {
+    first_ = index(1);
+    size_--;
+  }
+
+  void pop_back() { size_--; }
+ private:
+  std::size_t index(std::size_t i) const {
+    const std::size_t j = first_ + i;
+    return j < buffer_.size() ? j : j - buffer_.size();
+  }
+
+  std::vector<T> buffer_;
+  std::size_t first_ = 0;
+  std::size_t size_ = 0;
+};
+
+/// Lock-free single-producer single-consumer queue of fixed capacity. The
+/// producer and consumer indices live on separate cache lines.
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(std::size_t capacity) : buffer_(capacity + 1) {}
+
+  std::size_t capacity() const { return buffer_.size() - 1; }
+
+  // Removes all values. Not thread safe.
+  void clear() {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+  // Appends a value (producer only). Returns false if full.
+  bool push(const T& value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t next = tail + 1 == buffer_.size() ? 0 : tail + 1;
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    buffer_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Removes the front value (consumer only). Returns false if empty.
+  bool pop(T& value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    value = buffer_[head];
+    head_.store(head + 1 == buffer_.size() ? 0 : head + 1, std::memory_order_release);
+    return true;
+  }
+ private:
+  static constexpr std::size_t cache_line = 64;
+
+  std::vector<T> buffer_;
+  alignas(cache_line) std::atomic<std::size_t> head_ = 0;
+  alignas(cache_line) std::atomic<std::size_t> tail_ = 0;
+};
+
+} // namespace reverse
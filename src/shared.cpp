@@ -0,0 +1 @@
+#include "shared.h"
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "pcg.h"
+#include "reverse.h"
+
+namespace reverse {
+
+/// Reversible random number generator that is shared by multiple threads
+/// without a lock. The sequence is defined by position, as for ReversibleRNG.
+/// Threads atomically claim blocks of positions from a shared cursor with
+/// `reserve`, and generate the values of a block with `values` from their own
+/// copy of the engine, which jumps to the block in logarithmic time. The most
+/// recent block can be returned to the sequence with `release_back`, which
+/// moves the cursor back (reverses the generator).
+///
+/// Requires a distribution with a fixed number of draws per value and an
+/// engine with an `advance` function. Seeding and streaming are not thread
+/// safe.
+template <typename DistType = UniformDistribution<>,
+          typename EngineType = ReversiblePCG<>>
+class SharedReversibleRNG {
+  using RNG = ReversibleRNG<DistType, EngineType>;
+  static_assert(RNG::block_size > 1 || DrawsPerValue<DistType, EngineType>::value != 0,
+      "Distribution must have a fixed number of draws per value");
+  static_assert(util::has_advance<EngineType>::value,
+      "Engine must be able to jump ahead");
+ public:
+  using result_type = typename RNG::result_type;
+
+  /// Block of consecutive positions claimed by a thread
+  struct Block {
+    std::int64_t position;
+    std::size_t size;
+  };
+
+  template <typename... Args>
+  explicit SharedReversibleRNG(Args&&... args) : rng_(std::forward<Args>(args)...) {}
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    rng_.seed(std::forward<Args>(params)...);
+    cursor_ = 0;
+  }
+
+  result_type min() const { return rng_.min(); }
+  result_type max() const { return rng_.max(); }
+
+  // Claims the next block of `n` positions
+  Block reserve(std::size_t n) {
+    return {cursor_.fetch_add(std::int64_t(n), std::memory_order_relaxed), n};
+  }
+
+  // Returns the values of a block
+  std::vector<result_type> values(const Block& block) const {
+    std::vector<result_type> values(block.size);
+    values_to(block, values.data());
+    return values;
+  }
+
+  // Writes the values of a block to the given output
+  template <typename OutputIt>
+  void values_to(const Block& block, OutputIt out) const {
+    RNG rng(rng_);
+    rng.seek(block.position);
+    for (std::size_t n = 0; n < block.size; ++n) {
+      *out++ = rng.next();
+    }
+  }
+
+  // Returns the most recent block to the sequence. Fails (returns false) if a
+  // later block has been claimed.
+  bool release_back(const Block& block) {
+    std::int64_t end = block.position + std::int64_t(block.size);
+    return cursor_.compare_exchange_strong(end, block.position, std::memory_order_relaxed);
+  }
+
+  // Returns the position of the next unclaimed value
+  std::int64_t position() const { return cursor_.load(std::memory_order_relaxed); }
+
+  friend std::ostream& operator<<(std::ostream& os, const SharedReversibleRNG& rng) {
+    const auto flags = os.flags(std::ios_base::dec | std::ios_base::left);
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << rng.rng_ << space << rng.position();
+
+    os.flags(flags);
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, SharedReversibleRNG& rng) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    std::int64_t position;
+    is >> rng.rng_ >> position;
+    rng.cursor_ = position;
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  // Generator at position zero, which is copied by every block
+  RNG rng_;
+  std::atomic<std::int64_t> cursor_ = 0;
+};
+
+} // namespace reverse
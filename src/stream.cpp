@@ -0,0 +1 @@
+#include "stream.h"
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "counting.h"
+#include "pcg.h"
+#include "reverse.h"
+
+#include "pcg_extras.hpp"
+
+namespace reverse {
+
+/// Reversible random number generator that is not tied to a single probability
+/// distribution. Owns one reversible engine and one position counter, and
+/// generates values on any distribution object passed to `next`/`previous`
+/// e.g. interleaved uniform, normal and exponential values. Values have to be
+/// reversed with the same distributions in reverse order.
+///
+/// Rejection-based distributions (e.g. NormalDistribution) leave their
+/// rejected draws behind the accepted one when reversed, which would be taken
+/// by the preceding value of another distribution. Hence, the number of draws
+/// of every value on a distribution without a fixed number of draws (see
+/// DrawsPerValue) is recorded in a DrawLog (about 1 byte per value), and the
+/// value is recomputed on reversal. Such distributions are reset before every
+/// value.
+template <typename EngineType = ReversiblePCG<>>
+class ReversibleStream {
+  template <typename DistType>
+  using result_t = typename std::decay<DistType>::type::result_type;
+ public:
+  ReversibleStream() {
+    // Randomly seed from a non-deterministic source if available e.g. /dev/random
+    pcg_extras::seed_seq_from<std::random_device> seed_source;
+    seed(seed_source);
+  }
+
+  // Constructs a stream with the default seed of the engine
+  explicit ReversibleStream(DeferSeed) {}
+
+  // Constructs a stream with the given seed
+  explicit ReversibleStream(Seed sd) { seed(sd.value); }
+
+  template <typename... Args>
+  void seed(Args&&... params) {
+    engine_.seed(std::forward<Args>(params)...);
+    position_ = 0;
+    log_.clear();
+  }
+
+  // Returns the next random value on the given distribution
+  template <typename DistType>
+  result_t<DistType> next(DistType&& dist) {
+    position_++;
+    if constexpr (fixed_draws<DistType>()) {
+      return dist(engine_);
+    } else {
+      CountingEngine counter(engine_);
+      dist.reset();
+      const result_t<DistType> result = dist(counter);
+      log_.push(counter.count());
+      return result;
+    }
+  }
+
+  // Returns the previous random value on the given distribution
+  template <typename DistType>
+  result_t<DistType> previous(DistType&& dist) {
+    if constexpr (fixed_draws<DistType>()) {
+      ReversedEngine reversed(engine_);
+      position_--;
+      return dist(reversed);
+    } else {
+      for (std::uint64_t count = log_.pop(); count != 0; --count) {
+        engine_.previous();
+      }
+
+      position_--;
+      EngineType replay(std::as_const(engine_));
+      dist.reset();
+      return dist(replay);
+    }
+  }
+
+  // Returns a vector of the next random values on the given distribution
+  template <typename DistType>
+  std::vector<result_t<DistType>> next(DistType&& dist, std::size_t N) {
+    std::vector<result_t<DistType>> values(N);
+    std::generate(values.begin(), values.end(), [&] { return next(dist); });
+    return values;
+  }
+
+  // Returns a vector of the previous random values on the given distribution
+  template <typename DistType>
+  std::vector<result_t<DistType>> previous(DistType&& dist, std::size_t N) {
+    std::vector<result_t<DistType>> values(N);
+    std::generate(values.rbegin(), values.rend(), [&] { return previous(dist); });
+    return values;
+  }
+
+  // Returns the number of values on the stream
+  inline std::int64_t position() const { return position_; }
+
+  // Returns the size of the draw count log in bytes
+  std::size_t log_size() const { return log_.size(); }
+
+  friend bool operator==(const ReversibleStream& lhs, const ReversibleStream& rhs) {
+    return lhs.engine_ == rhs.engine_ && lhs.position() == rhs.position()
+        && lhs.log_ == rhs.log_;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const ReversibleStream& stream) {
+    const auto flags = os.flags(std::ios_base::dec | std::ios_base::fixed | std::ios_base::left);
+    const auto space = os.widen(' ');
+    const auto fill = os.fill(space);
+
+    os << stream.engine_ << space << stream.position() << space << stream.log_;
+
+    os.flags(flags);
+    os.fill(fill);
+    return os;
+  }
+
+  friend std::istream& operator>>(std::istream& is, ReversibleStream& stream) {
+    const auto flags = is.flags(std::ios_base::dec | std::ios_base::skipws);
+
+    is >> stream.engine_ >> stream.position_ >> stream.log_;
+
+    is.flags(flags);
+    return is;
+  }
+ private:
+  template <typename DistType>
+  static constexpr bool fixed_draws() {
+    return DrawsPerValue<typename std::decay<DistType>::type, EngineType>::value != 0;
+  }
+
+  EngineType engine_;
+  std::int64_t position_ = 0;
+  DrawLog log_;
+};
+
+} // namespace reverse
@@ -0,0 +1 @@
+#include "tape.h"
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "mmap.h"
+#include "normal.h"
+#include "reverse.h"
+
+namespace reverse {
+
+/// Recording of a window of the random number sequence of a generator in a
+/// memory-mapped file, for workloads that replay the same values many times
+/// in both directions. The window of `length` values after the position of
+/// the given generator is generated once (by multiple threads, see
+/// `ReversibleRNG::next(N, Parallel)`), after which `next`/`previous`/`seek`
+/// within the window only read the mapping e.g. instead of recomputing
+/// ziggurat values. Outside of the window, values are regenerated by one of
+/// two copies of the generator, which stay before and after the window, so
+/// that a miss on either side does not cross the window. The values are
+/// identical to those of the generator itself. The file is a cache in the byte
+/// order of the host.
+template <typename RNG = NormalRNG<>>
+class RandomTape {
+ public:
+  using result_type = typename RNG::result_type;
+  using distribution_type = typename RNG::distribution_type;
+  using engine_type = typename RNG::engine_type;
+
+  // Number of values generated at a time while recording, which bounds the
+  // memory in addition to the mapping
+  static constexpr std::size_t record_chunk = std::size_t(1) << 22;
+
+  // Records the `length` values after the position of `rng` in the file at
+  // `path`, which is replaced
+  RandomTape(const RNG& rng, std::size_t length, const std::string& path,
+             Parallel policy = {})
+      : before_(rng), after_(rng), file_(replace(path), length * sizeof(result_type)),
+        first_(rng.position()), last_(first_ + std::int64_t(length)), position_(first_) {
+    for (std::size_t offset = 0; offset < length; offset += record_chunk) {
+      const std::vector<result_type> values =
+          after_.next(std::min(record_chunk, length - offset), policy);
+      std::memcpy(file_.data() + offset * sizeof(result_type), values.data(),
+                  values.size() * sizeof(result_type));
+    }
+  }
+
+  // Returns the first position of the recorded window
+  std::int64_t first() const { return first_; }
+
+  // Returns the position past the end of the recorded window
+  std::int64_t last() const { return last_; }
+
+  // Returns whether the value at the given position is recorded
+  bool recorded(std::int64_t position) const { return position >= first_ && position < last_; }
+
+  result_type operator()() { return next(); }
+
+  result_type next() {
+    if (recorded(position_)) {
+      return value(position_++);
+    }
+
+    RNG& rng = outside(position_);
+    rng.seek(position_++);
+    return rng.next();
+  }
+
+  result_type previous() {
+    if (recorded(position_ - 1)) {
+      return value(--position_);
+    }
+
+    RNG& rng = outside(position_ - 1);
+    rng.seek(position_--);
+    return rng.previous();
+  }
+
+  std::vector<result_type> next(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.begin(), values.end(), [&] { return next(); });
+    return values;
+  }
+
+  std::vector<result_type> previous(std::size_t N) {
+    std::vector<result_type> values(N);
+    std::generate(values.rbegin(), values.rend(), [&] { return previous(); });
+    return values;
+  }
+
+  template <std::size_t N>
+  auto next() {
+    return get(std::make_index_sequence<N>{}, next(N));
+  }
+
+  template <std::size_t N>
+  auto previous() {
+    return get(std::make_index_sequence<N>{}, previous(N));
+  }
+
+  void discard(unsigned long long z) { seek(position_ + std::int64_t(z)); }
+
+  // Moves to the given position on the random number sequence. The generator
+  // only moves when a value outside of the window is requested.
+  void seek(std::int64_t position) { position_ = position; }
+
+  inline std::int64_t position() const { return position_; }
+ private:
+  static const std::string& replace(const std::string& path) {
+    std::remove(path.c_str());
+    return path;
+  }
+
+  template <std::size_t... Is, typename T>
+  static auto get(std::index_sequence<Is...>, const std::vector<T>& values) {
+    return std::make_tuple(values[Is]...);
+  }
+
+  // Returns the copy of the generator on the side of the window of the given
+  // (unrecorded) position
+  RNG& outside(std::int64_t position) { return position < first_ ? before_ : after_; }
+
+  result_type value(std::int64_t position) const {
+    result_type result;
+    std::memcpy(&result, file_.data() + (position - first_) * sizeof(result_type),
+                sizeof(result_type));
+    return result;
+  }
+
+  RNG before_, after_;
+  MappedFile file_;
+  std::int64_t first_, last_;
+  std::int64_t position_;
+};
+
+} // namespace reverse
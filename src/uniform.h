@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <ios>
 #include <istream>
@@ -9,6 +11,7 @@
 #include <stdexcept>
 #include <type_traits>
 
+#include "binary.h"
 #include "xoshiro.h"
 
 #include "pcg_extras.hpp"
@@ -97,6 +100,20 @@ class UniformIntDistribution {
   template <typename URNG>
   result_type operator()(URNG& urng);
 
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = 2 * sizeof(result_type);
+
+  // Writes the parameters in little-endian byte order and returns the end of
+  // the written bytes
+  std::byte* save(std::byte* out) const {
+    return util::store(util::store(out, a_), b_);
+  }
+
+  // Reads the parameters written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) {
+    return util::fetch(util::fetch(in, a_), b_);
+  }
+
   friend bool operator==(const UniformIntDistribution& lhs,
                          const UniformIntDistribution& rhs) {
     return lhs.a() == rhs.a() && lhs.b() == rhs.b();
@@ -191,6 +208,34 @@ class UniformRealDistribution {
   template <typename URNG>
   result_type operator()(URNG& urng);
 
+  // Number of values produced per 64-bit engine draw (see Blocked)
+  static constexpr std::size_t values_per_draw = std::is_same<result_type, float>::value ? 2 : 1;
+
+  // Returns the values of a single 64-bit engine draw. A float only needs 24
+  // random bits, so the high and low halves of the draw produce two values.
+  std::array<result_type, values_per_draw> block(std::uint64_t bits) const {
+    if constexpr (values_per_draw == 2) {
+      return {util::float32(bits >> 32) * (b() - a()) + a(),
+              util::float32(std::uint32_t(bits)) * (b() - a()) + a()};
+    } else {
+      return {result_type(util::float64(bits)) * (b() - a()) + a()};
+    }
+  }
+
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = 2 * sizeof(result_type);
+
+  // Writes the parameters in little-endian byte order and returns the end of
+  // the written bytes
+  std::byte* save(std::byte* out) const {
+    return util::store(util::store(out, a_), b_);
+  }
+
+  // Reads the parameters written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) {
+    return util::fetch(util::fetch(in, a_), b_);
+  }
+
   friend bool operator==(const UniformRealDistribution& lhs,
                          const UniformRealDistribution& rhs) {
     return lhs.a() == rhs.a() && lhs.b() == rhs.b();
@@ -11,6 +11,10 @@ UniformRNG<double>* uniform_real_create(double a, double b) {
   return new UniformRNG<double>(a, b);
 }
 
+UniformRNG<double>* uniform_real_create_seeded(double a, double b, unsigned long long sd) {
+  return new UniformRNG<double>(Seed{sd}, a, b);
+}
+
 void uniform_real_destroy(UniformRNG<double>* rng) {
   delete rng;
 }
@@ -42,6 +46,10 @@ UniformRNG<int>* uniform_int_create(int a, int b) {
   return new UniformRNG<int>(a, b);
 }
 
+UniformRNG<int>* uniform_int_create_seeded(int a, int b, unsigned long long sd) {
+  return new UniformRNG<int>(Seed{sd}, a, b);
+}
+
 void uniform_int_destroy(UniformRNG<int>* rng) {
   delete rng;
 }
@@ -73,6 +81,10 @@ NormalRNG<double>* normal_create(double mean, double stddev) {
   return new NormalRNG<double>(mean, stddev);
 }
 
+NormalRNG<double>* normal_create_seeded(double mean, double stddev, unsigned long long sd) {
+  return new NormalRNG<double>(Seed{sd}, mean, stddev);
+}
+
 void normal_destroy(NormalRNG<double>* rng) {
   delete rng;
 }
@@ -104,6 +116,10 @@ ExponentialRNG<double>* exponential_create(double lambda) {
   return new ExponentialRNG<double>(lambda);
 }
 
+ExponentialRNG<double>* exponential_create_seeded(double lambda, unsigned long long sd) {
+  return new ExponentialRNG<double>(Seed{sd}, lambda);
+}
+
 void exponential_destroy(ExponentialRNG<double>* rng) {
   delete rng;
 }
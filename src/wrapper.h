@@ -7,6 +7,7 @@ namespace reverse {
 extern "C" {
 
 UniformRNG<double>* uniform_real_create(double, double);
+UniformRNG<double>* uniform_real_create_seeded(double, double, unsigned long long);
 void uniform_real_destroy(UniformRNG<double>*);
 void uniform_real_seed(UniformRNG<double>*, unsigned long long);
 double uniform_real_next(UniformRNG<double>*);
@@ -15,6 +16,7 @@ void uniform_real_next_array(UniformRNG<double>*, double[], size_t);
 void uniform_real_previous_array(UniformRNG<double>*, double[], size_t);
 
 UniformRNG<int>* uniform_int_create(int, int);
+UniformRNG<int>* uniform_int_create_seeded(int, int, unsigned long long);
 void uniform_int_destroy(UniformRNG<int>*);
 void uniform_int_seed(UniformRNG<int>*, unsigned long long);
 int uniform_int_next(UniformRNG<int>*);
@@ -23,6 +25,7 @@ void uniform_int_next_array(UniformRNG<int>*, int[], size_t);
 void uniform_int_previous_array(UniformRNG<int>*, int[], size_t);
 
 NormalRNG<double>* normal_create(double, double);
+NormalRNG<double>* normal_create_seeded(double, double, unsigned long long);
 void normal_destroy(NormalRNG<double>*);
 void normal_seed(NormalRNG<double>*, unsigned long long);
 double normal_next(NormalRNG<double>*);
@@ -31,6 +34,7 @@ void normal_next_array(NormalRNG<double>*, double[], size_t);
 void normal_previous_array(NormalRNG<double>*, double[], size_t);
 
 ExponentialRNG<double>* exponential_create(double);
+ExponentialRNG<double>* exponential_create_seeded(double, unsigned long long);
 void exponential_destroy(ExponentialRNG<double>*);
 void exponential_seed(ExponentialRNG<double>*, unsigned long long);
 double exponential_next(ExponentialRNG<double>*);
@@ -10,6 +10,20 @@ void Xoshiro256::seed(result_type sd) {
   std::generate(state_.begin(), state_.end(), [&rng] { return rng(); });
 }
 
+std::byte* Xoshiro256::save(std::byte* out) const {
+  for (const auto& state: state_) {
+    out = util::store(out, state);
+  }
+  return out;
+}
+
+const std::byte* Xoshiro256::load(const std::byte* in) {
+  for (auto& state: state_) {
+    in = util::fetch(in, state);
+  }
+  return in;
+}
+
 void Xoshiro256::discard(unsigned long long z) {
   for (; z != 0ULL; --z) {
     (*this)();
@@ -58,6 +72,15 @@ void Xoshiro256::jump() {
   state_[3] = s3;
 }
 
+Xoshiro256 Xoshiro256::substream(std::uint64_t i) const {
+  Xoshiro256 rng(*this);
+  rng.long_jump();
+  for (std::uint64_t jumps = 0; jumps < i; ++jumps) {
+    rng.jump();
+  }
+  return rng;
+}
+
 void Xoshiro256::long_jump() {
   result_type s0 = 0;
   result_type s1 = 0;
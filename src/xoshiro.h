@@ -1,11 +1,16 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <istream>
 #include <limits>
 #include <ostream>
+#include <random>
 #include <type_traits>
+#include <utility>
+
+#include "binary.h"
 
 namespace reverse {
 
@@ -23,12 +28,27 @@ class Splitmix64 {
   static constexpr result_type min() { return std::numeric_limits<result_type>::lowest(); }
   static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
 
-  result_type operator()() {
-    result_type z = (x_ += 0x9e3779b97f4a7c15);
+  result_type operator()() { return mix(x_ += 0x9e3779b97f4a7c15); }
+
+  // Output function (finalizer) of the generator, a bijective mix of all bits
+  static constexpr result_type mix(result_type z) {
     z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
     z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
     return z ^ (z >> 31);
   }
+
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = sizeof(result_type);
+
+  // Writes the state in little-endian byte order and returns the end of the
+  // written bytes
+  std::byte* save(std::byte* out) const { return util::store(out, x_); }
+
+  // Reads the state written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in) { return util::fetch(in, x_); }
+
+  // Skips `z` outputs in constant time
+  void discard(unsigned long long z) { x_ += z * 0x9e3779b97f4a7c15; }
  private:
   result_type x_;
 };
@@ -71,12 +91,30 @@ class Xoshiro256 {
   // subsequences for parallel computations.
   void jump();
 
+  // Returns a copy of the generator on the `i`th substream, which starts
+  // 2^192 + i * 2^128 calls to operator() ahead (one long_jump() and i calls
+  // to jump()). Each nesting level adds a long jump, so substreams of
+  // substreams do not overlap with direct substreams or with each other if
+  // every stream uses less than 2^128 values. Nested substreams commute, i.e.
+  // substream(a).substream(b) equals substream(b).substream(a).
+  Xoshiro256 substream(std::uint64_t i) const;
+
   // This is the long-jump function for the generator. It is equivalent to 2^192
   // calls to operator() it can be used to generate 2^64 starting points, from
   // each of which jump() will generate 2^64 non-overlapping subsequences for
   // parallel distributed computations.
   void long_jump();
 
+  // Size of the binary form (see `save`) in bytes
+  static constexpr std::size_t binary_size = 4 * sizeof(result_type);
+
+  // Writes the state in little-endian byte order and returns the end of the
+  // written bytes
+  std::byte* save(std::byte* out) const;
+
+  // Reads the state written by `save` and returns the end of the read bytes
+  const std::byte* load(const std::byte* in);
+
   friend bool operator==(const Xoshiro256& lhs, const Xoshiro256& rhs) {
     return lhs.state_ == rhs.state_;
   }
@@ -99,4 +137,44 @@ auto Xoshiro256::seed(Sseq& q)
   seed(std::uint64_t(arr[1]) << 32 | arr[0]);
 }
 
+namespace util {
+
+template <typename URBG, typename = void>
+struct has_substream : std::false_type {};
+
+template <typename URBG>
+struct has_substream<URBG, std::void_t<decltype(std::declval<const URBG&>().substream(0))>>
+    : std::true_type {};
+
+// Returns a 64-bit key from the next two outputs of an engine. The outputs
+// are drawn in a fixed order, and every bit of 64-bit outputs is mixed in.
+template <typename URBG>
+std::uint64_t draw_key(URBG& engine) {
+  const std::uint64_t hi = engine();
+  const std::uint64_t lo = engine();
+  return Splitmix64::mix(hi ^ (lo << 32 | lo >> 32));
+}
+
+// Returns a copy of an engine on its `i`th substream. Engines without a
+// `substream` function (e.g. ReversibleMersenne) are reseeded from their next
+// outputs mixed with `i` by Splitmix64. These streams are distinct, but not
+// guaranteed to be non-overlapping.
+template <typename URBG>
+URBG substream(const URBG& engine, std::uint64_t i) {
+  if constexpr (has_substream<URBG>::value) {
+    return engine.substream(i);
+  } else {
+    URBG copy(engine);
+    Splitmix64 mix(draw_key(copy) ^ Splitmix64::mix(i));
+    const std::uint64_t s1 = mix();
+    const std::uint64_t s2 = mix();
+    std::seed_seq seq{std::uint32_t(s1), std::uint32_t(s1 >> 32),
+                      std::uint32_t(s2), std::uint32_t(s2 >> 32)};
+    copy.seed(seq);
+    return copy;
+  }
+}
+
+} // namespace util
+
 } /// namespace reverse
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <limits>
 #include <random>
 #include <string>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 #include <boost/core/demangle.hpp>
 
+#include "pcg.h"
+#include "reverse.h"
+
 extern "C" {
 #include <bbattery.h>
 #include <unif01.h>
@@ -64,6 +70,21 @@ class TestU01Battery : Generator {
     bbattery_BigCrush(&gen_);
   }
 
+  // The repeat functions run the `i`th test of a battery `rep[i]` times
+  // (indexed from 1, see `TestCount`), and skip the tests with zero entries
+
+  void RepeatSmallCrush(std::vector<int> rep) {
+    bbattery_RepeatSmallCrush(&gen_, rep.data());
+  }
+
+  void RepeatCrush(std::vector<int> rep) {
+    bbattery_RepeatCrush(&gen_, rep.data());
+  }
+
+  void RepeatBigCrush(std::vector<int> rep) {
+    bbattery_RepeatBigCrush(&gen_, rep.data());
+  }
+
   std::uint32_t bits() override {
     // return urng_() >> 32; // Test low bits of 64-bit generator
     return urng_();
@@ -77,3 +98,111 @@ class TestU01Battery : Generator {
   unif01_Gen gen_;
   URNG urng_;
 };
+
+// Number of tests of the TestU01 batteries
+constexpr int SMALL_CRUSH_TESTS = 10;
+constexpr int CRUSH_TESTS = 96;
+constexpr int BIG_CRUSH_TESTS = 106;
+
+// Returns the test names and p-values of the last battery that was run
+inline std::vector<std::pair<std::string, double>> BatteryResults() {
+  std::vector<std::pair<std::string, double>> results;
+  for (int i = 0; i < bbattery_NTests; ++i) {
+    results.emplace_back(bbattery_TestNames[i], bbattery_pVal[i]);
+  }
+  return results;
+}
+
+/// Wrapper class that outputs the low 32 bits of the forward stream of a
+/// reversible engine.
+template <typename RURNG = reverse::ReversiblePCG<>>
+class ForwardStream {
+ public:
+  using result_type = std::uint32_t;
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::lowest(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  void seed(std::uint64_t seed) { engine_.seed(seed); }
+
+  result_type operator()() { return engine_(); }
+
+  friend std::ostream& operator<<(std::ostream& os, const ForwardStream& rng) {
+    return os << rng.engine_;
+  }
+ private:
+  RURNG engine_;
+};
+
+/// Wrapper class that outputs the low 32 bits of the reversed stream (the
+/// values of `previous`) of a reversible engine through ReversedEngine.
+template <typename RURNG = reverse::ReversiblePCG<>>
+class ReversedStream {
+ public:
+  using result_type = std::uint32_t;
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::lowest(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  void seed(std::uint64_t seed) { engine_.seed(seed); }
+
+  result_type operator()() { return reversed_(); }
+
+  friend std::ostream& operator<<(std::ostream& os, const ReversedStream& rng) {
+    return os << rng.engine_;
+  }
+ private:
+  RURNG engine_;
+  reverse::ReversedEngine<RURNG> reversed_{engine_};
+};
+
+/// Wrapper class that converts our normally distributed random number
+/// generator to a uniformly distributed generator. This allows for testing
+/// with uniform batteries e.g. TestU01 BigCrush. Conversion is done with the
+/// normal CDF function.
+template <typename EngineType = reverse::ReversiblePCG<>>
+class NormalCDF {
+ public:
+  using result_type = std::uint32_t;
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::lowest(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  void seed(std::uint64_t seed) { rng_.seed(seed); }
+
+  result_type operator()() {
+    const auto normal = rng_.next();
+    return std::erfc(-normal / std::sqrt(2)) / 2 * unif01_NORM32;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const NormalCDF& rng) {
+    return os << rng.rng_;
+  }
+ private:
+  reverse::ReversibleRNG<reverse::NormalDistribution<>, EngineType> rng_;
+};
+
+/// Wrapper class that converts our exponentially distributed random number
+/// generator to a uniformly distributed generator with the exponential CDF
+/// function.
+template <typename EngineType = reverse::ReversiblePCG<>>
+class ExponentialCDF {
+ public:
+  using result_type = std::uint32_t;
+
+  static constexpr result_type min() { return std::numeric_limits<result_type>::lowest(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  void seed(std::uint64_t seed) { rng_.seed(seed); }
+
+  result_type operator()() {
+    const auto exponential = rng_.next();
+    return -std::expm1(-exponential) * unif01_NORM32;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const ExponentialCDF& rng) {
+    return os << rng.rng_;
+  }
+ private:
+  reverse::ReversibleRNG<reverse::ExponentialDistribution<>, EngineType> rng_;
+};
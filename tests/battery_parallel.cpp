@@ -0,0 +1,244 @@
+#include "battery.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mersenne.h"
+#include "pcg.h"
+#include "xoshiro.h"
+
+using namespace reverse;
+
+/// Runs the tests of a TestU01 battery on the forward, reversed, normal CDF
+/// and exponential CDF streams of several reversible engines. Every (stream,
+/// test) pair is a job that runs in its own worker process with a single
+/// entry in the `rep` array of `bbattery_Repeat*`, seeded from Splitmix64 by
+/// the test index. At most `--workers` processes run at a time. The p-values
+/// of the workers are sent back through pipes and merged into one report.
+
+enum class Battery { SMALL_CRUSH, CRUSH, BIG_CRUSH };
+
+using Results = std::vector<std::pair<std::string, double>>;
+
+struct Stream {
+  std::string name;
+  std::function<Results(Battery, int, std::uint64_t)> run;
+};
+
+static int TestCount(Battery battery) {
+  switch (battery) {
+    case Battery::SMALL_CRUSH: return SMALL_CRUSH_TESTS;
+    case Battery::CRUSH: return CRUSH_TESTS;
+    default: return BIG_CRUSH_TESTS;
+  }
+}
+
+template <typename URNG>
+static Stream MakeStream() {
+  return {boost::core::demangle(typeid(URNG).name()),
+          [](Battery battery, int test, std::uint64_t seed) {
+    TestU01Battery<URNG> tester(seed);
+    std::vector<int> rep(TestCount(battery) + 1, 0);
+    rep[test] = 1;
+    switch (battery) {
+      case Battery::SMALL_CRUSH: tester.RepeatSmallCrush(rep); break;
+      case Battery::CRUSH: tester.RepeatCrush(rep); break;
+      default: tester.RepeatBigCrush(rep); break;
+    }
+    return BatteryResults();
+  }};
+}
+
+template <typename RURNG>
+static void AddStreams(std::vector<Stream>& streams) {
+  streams.push_back(MakeStream<ForwardStream<RURNG>>());
+  streams.push_back(MakeStream<ReversedStream<RURNG>>());
+  // The normal and exponential distributions require 64-bit engines
+  if constexpr (util::range<RURNG>() == std::numeric_limits<std::uint64_t>::max()) {
+    streams.push_back(MakeStream<NormalCDF<RURNG>>());
+    streams.push_back(MakeStream<ExponentialCDF<RURNG>>());
+  }
+}
+
+struct Job {
+  std::size_t stream;
+  int test;
+};
+
+struct Worker {
+  Job job;
+  int fd;
+};
+
+// Runs a job in the current (child) process and writes its p-values to `fd`
+[[noreturn]] static void RunJob(const Stream& stream, Battery battery, Job job,
+                                std::uint64_t seed, int fd) {
+  // TestU01 reports are replaced by the merged report of the parent
+  const int null = open("/dev/null", O_WRONLY);
+  dup2(null, STDOUT_FILENO);
+
+  try {
+    Splitmix64 mix(seed);
+    mix.discard(job.test);
+
+    std::ostringstream os;
+    os << std::setprecision(17);
+    for (const auto& [name, p]: stream.run(battery, job.test, mix())) {
+      os << name << '\t' << p << '\n';
+    }
+
+    const std::string text = os.str();
+    for (std::size_t written = 0; written < text.size();) {
+      const ssize_t n = write(fd, text.data() + written, text.size() - written);
+      if (n <= 0) {
+        _exit(EXIT_FAILURE);
+      }
+      written += n;
+    }
+    _exit(EXIT_SUCCESS);
+  } catch (...) {
+    _exit(EXIT_FAILURE);
+  }
+}
+
+static std::string ReadAll(int fd) {
+  std::string text;
+  char buffer[4096];
+  for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+    text.append(buffer, n);
+  }
+  close(fd);
+  return text;
+}
+
+int main(int argc, char* argv[]) {
+  Battery battery = Battery::BIG_CRUSH;
+  std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  std::uint64_t seed = std::random_device{}();
+  std::string filter;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i], value = argv[i + 1];
+    if (arg == "--battery") {
+      battery = value == "small" ? Battery::SMALL_CRUSH
+              : value == "crush" ? Battery::CRUSH : Battery::BIG_CRUSH;
+    } else if (arg == "--workers") {
+      workers = std::max<std::size_t>(1, std::stoul(value));
+    } else if (arg == "--seed") {
+      seed = std::stoull(value);
+    } else if (arg == "--filter") {
+      filter = value;
+    } else {
+      std::cerr << "Usage: battery_parallel [--battery small|crush|big] [--workers W]"
+                   " [--seed S] [--filter STREAM]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Stream> streams;
+  AddStreams<ReversiblePCG<pcg64>>(streams);
+  AddStreams<ReversiblePCG<pcg32>>(streams);
+  AddStreams<ReversibleMersenne>(streams);
+  streams.erase(std::remove_if(streams.begin(), streams.end(), [&](const Stream& stream) {
+    return stream.name.find(filter) == std::string::npos;
+  }), streams.end());
+
+  std::cout << "Seed: " << seed << std::endl;
+
+  std::vector<Job> jobs;
+  for (std::size_t s = 0; s < streams.size(); ++s) {
+    for (int test = 1; test <= TestCount(battery); ++test) {
+      jobs.push_back({s, test});
+    }
+  }
+
+  // P-values of each stream by test index
+  std::vector<std::map<int, Results>> results(streams.size());
+  std::map<pid_t, Worker> running;
+  std::size_t next = 0, failed = 0;
+  while (next < jobs.size() || !running.empty()) {
+    if (next < jobs.size() && running.size() < workers) {
+      int pipes[2];
+      if (pipe(pipes) != 0) {
+        throw std::runtime_error("Cannot create a pipe for a worker.");
+      }
+
+      const Job job = jobs[next++];
+      std::cout.flush();
+      const pid_t pid = fork();
+      if (pid == 0) {
+        close(pipes[0]);
+        RunJob(streams[job.stream], battery, job, seed, pipes[1]);
+      }
+      close(pipes[1]);
+      if (pid < 0) {
+        throw std::runtime_error("Cannot fork a worker.");
+      }
+      running[pid] = {job, pipes[0]};
+      continue;
+    }
+
+    int status;
+    const pid_t pid = waitpid(-1, &status, 0);
+    const auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+
+    const auto [job, fd] = it->second;
+    running.erase(it);
+    std::istringstream is(ReadAll(fd));
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cerr << streams[job.stream].name << ": test " << job.test << " failed to run"
+                << std::endl;
+      failed++;
+      continue;
+    }
+
+    Results& test = results[job.stream][job.test];
+    for (std::string name, p; std::getline(is, name, '\t') && std::getline(is, p);) {
+      test.emplace_back(name, std::stod(p));
+    }
+    std::cerr << "\rRemaining jobs: " << jobs.size() - next + running.size() << "   "
+              << std::flush;
+  }
+  std::cerr << std::endl;
+
+  // Merged report with the TestU01 summary convention: p-values outside of
+  // [0.001, 0.999] are listed, and those outside of [1e-10, 1 - 1e-10] fail
+  std::size_t suspect = 0, failures = 0;
+  for (std::size_t s = 0; s < streams.size(); ++s) {
+    std::cout << std::endl << streams[s].name << std::endl;
+    for (const auto& [index, tests]: results[s]) {
+      for (const auto& [name, p]: tests) {
+        const bool fail = p < 1e-10 || p > 1 - 1e-10;
+        const bool flagged = p < 0.001 || p > 0.999;
+        std::cout << std::setw(5) << index << "  " << std::left << std::setw(32) << name
+                  << std::right << std::setw(12) << std::setprecision(4) << p
+                  << (fail ? "  FAIL" : flagged ? "  suspect" : "") << std::endl;
+        suspect += flagged && !fail;
+        failures += fail;
+      }
+    }
+  }
+
+  std::cout << std::endl << "Suspect p-values: " << suspect << ", failures: " << failures
+            << ", tests that did not run: " << failed << std::endl;
+  return failures == 0 && failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
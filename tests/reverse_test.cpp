@@ -1,14 +1,45 @@
 #include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <numeric>
 #include <random>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#ifdef __unix__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include <catch2/catch_template_test_macros.hpp>
 
+#include "arena.h"
+#include "cache.h"
+#include "checkpoint.h"
+#include "counting.h"
+#include "event.h"
+#include "index.h"
 #include "mersenne.h"
+#include "mmap.h"
+#include "partition.h"
+#include "paths.h"
 #include "pcg.h"
+#include "prefetch.h"
 #include "reverse.h"
+#include "shared.h"
+#include "stream.h"
+#include "tape.h"
 
 #include "pcg_random.hpp"
 
@@ -18,12 +49,29 @@ using EngineTypes = std::tuple<
     ReversiblePCG<pcg32>, ReversiblePCG<pcg64>, // Standard PCG configurations
     ReversiblePCG<pcg64_fast>, // LCG increment of 0 which results in slightly reduced 2^126 period
     ReversiblePCG<pcg_engines::cm_setseq_xsl_rr_128_64>, // LCG "cheap" 128-bit multiplier
-    ReversibleMersenne>;
+    ReversibleMersenne,
+    CheckpointedEngine<std::mt19937>, CheckpointedEngine<std::mt19937_64>>;
 
 using GeneratorTypes = std::tuple<
     ExponentialRNG<float>, ExponentialRNG<double>, NormalRNG<float>, NormalRNG<double>,
     UniformRNG<int>, UniformRNG<long>, UniformRNG<float>, UniformRNG<double>>;
 
+using CheckpointedTypes = std::tuple<
+    CheckpointedEngine<std::minstd_rand>, CheckpointedEngine<std::ranlux48>,
+    CheckpointedEngine<std::mt19937_64>>;
+
+using DistributionTypes = std::tuple<
+    std::gamma_distribution<double>, std::student_t_distribution<double>,
+    std::normal_distribution<double>, std::binomial_distribution<int>>;
+
+using CachedTypes = std::tuple<
+    CachedRNG<UniformDistribution<float>>, CachedRNG<UniformDistribution<int>>,
+    CachedRNG<NormalDistribution<double>>, CachedRNG<ExponentialDistribution<double>>>;
+
+using IndexedTypes = std::tuple<
+    IndexedRNG<NormalDistribution<float>>, IndexedRNG<NormalDistribution<double>>,
+    IndexedRNG<UniformDistribution<int>>, IndexedRNG<UniformDistribution<long>>>;
+
 constexpr inline std::size_t N = 1'000'000;
 
 TEMPLATE_LIST_TEST_CASE("Reversible engine can reversed", "[reverse]",
@@ -155,6 +203,216 @@ TEMPLATE_LIST_TEST_CASE("Reversible RNG can be streamed", "[reverse]",
   REQUIRE(rng1 == rng2);
 }
 
+TEMPLATE_TEST_CASE("Reversible engine can be saved in binary", "[reverse]",
+    ReversiblePCG<pcg32>, ReversiblePCG<pcg64>, ReversiblePCG<pcg64_fast>,
+    ReversibleMersenne, Xoshiro256) {
+  TestType g1, g2;
+  g1.discard(N); // Arbitrarily advance the state
+
+  std::array<std::byte, TestType::binary_size> bytes;
+  REQUIRE(g1.save(bytes.data()) == bytes.data() + bytes.size());
+  REQUIRE(g2.load(bytes.data()) == bytes.data() + bytes.size());
+
+  REQUIRE(g1 == g2);
+  REQUIRE(g1() == g2());
+}
+
+TEST_CASE("Binary form is little-endian", "[reverse]") {
+  std::array<std::byte, 8> bytes;
+  util::store(bytes.data(), std::uint64_t(0x0102030405060708));
+  REQUIRE(bytes[0] == std::byte(0x08));
+  REQUIRE(bytes[7] == std::byte(0x01));
+
+  double value;
+  util::store(bytes.data(), -1.5);
+  util::fetch(bytes.data(), value);
+  REQUIRE(value == -1.5);
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible RNG can be saved in binary", "[reverse]",
+    GeneratorTypes) {
+  std::vector<TestType> rngs(16), copies(16);
+  for (auto& rng: rngs) {
+    rng.next(N / 16 + 1); // Arbitrarily advance the state
+  }
+
+  std::vector<std::byte> bytes(rngs.size() * TestType::binary_size);
+  REQUIRE(save(rngs.data(), rngs.size(), bytes.data()) == bytes.data() + bytes.size());
+  REQUIRE(load(copies.data(), copies.size(), bytes.data()) == bytes.data() + bytes.size());
+
+  REQUIRE(std::equal(rngs.begin(), rngs.end(), copies.begin()));
+  REQUIRE(rngs.back().next(N) == copies.back().next(N));
+  REQUIRE(rngs.back().previous(N + 1) == copies.back().previous(N + 1));
+
+  bytes[0] = std::byte(0xff); // Unsupported version
+  REQUIRE_THROWS_AS(copies.front().load(bytes.data()), std::runtime_error);
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible RNG can seek", "[reverse]",
+    GeneratorTypes) {
+  TestType rng;
+
+  const auto values = rng.next(N);
+  const std::size_t n = N / 3;
+
+  rng.seek(n);
+  REQUIRE(rng.position() == n);
+  REQUIRE(rng.next() == values[n]);
+
+  rng.seek(N - 1);
+  REQUIRE(rng.next() == values.back());
+
+  rng.seek(0);
+  REQUIRE(rng.next(N) == values);
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible RNG can be reversed in parallel", "[reverse]",
+    GeneratorTypes) {
+  TestType rng;
+  rng.next(3);
+  TestType serial(std::as_const(rng));
+
+  REQUIRE(rng.next(N, Parallel{4}) == serial.next(N));
+  REQUIRE(rng == serial);
+  REQUIRE(rng.next() == serial.next());
+
+  REQUIRE(rng.previous(N, Parallel{3}) == serial.previous(N));
+  REQUIRE(rng == serial);
+  REQUIRE(rng.previous() == serial.previous());
+
+  REQUIRE(rng.previous(N / 2, Parallel{}) == serial.previous(N / 2));
+  REQUIRE(rng.next(N, Parallel{2}) == serial.next(N));
+  REQUIRE(rng == serial);
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible engine can be split into substreams", "[reverse]",
+    EngineTypes) {
+  ReversibleRNG<UniformDistribution<unsigned>, TestType> rng;
+  rng.next(N);
+
+  auto first = rng.split(0), second = rng.split(1), again = rng.split(0);
+  REQUIRE(first == again);
+  REQUIRE(first.position() == 0);
+
+  const auto values = first.next(N);
+  REQUIRE(values != second.next(N));
+  REQUIRE(values != rng.next(N));
+  REQUIRE(first.previous(N) == values);
+
+  // Nested splits do not compose to other splits
+  for (const auto& [a, b]: {std::pair<std::uint64_t, std::uint64_t>{0, 1}, {1, 2}, {3, 5}}) {
+    const auto nested = rng.split(a).split(b).next(N);
+    REQUIRE(nested != rng.split(b).split(a).next(N));
+    REQUIRE(nested != rng.split(a ^ b).next(N));
+    REQUIRE(nested != rng.split(a + b + 1).next(N));
+  }
+}
+
+TEST_CASE("Xoshiro substreams are a long jump and a jump per id ahead", "[reverse]") {
+  Xoshiro256 engine(42);
+  engine.discard(10);
+
+  Xoshiro256 expected(std::as_const(engine));
+  expected.long_jump();
+  for (int jumps = 0; jumps < 3; ++jumps) {
+    expected.jump();
+  }
+  REQUIRE(engine.substream(3) == expected);
+
+  // Every nesting level adds a long jump
+  REQUIRE(engine.substream(1).substream(2) == engine.substream(2).substream(1));
+  REQUIRE(!(engine.substream(1).substream(2) == engine.substream(3)));
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible RNG can be constructed without a random device", "[reverse]",
+    GeneratorTypes) {
+  const std::uint64_t sd = std::random_device{}();
+  TestType seeded(Seed{sd}), rng;
+  rng.seed(sd);
+  REQUIRE(seeded == rng);
+  REQUIRE(TestType(defer_seed) == TestType(defer_seed));
+
+  // Copies of non-const generators are not taken for distribution parameters
+  TestType copy(rng);
+  REQUIRE(copy == rng);
+
+  const TestType child(rng, 0), sibling(rng, 1), again(rng, 0);
+  REQUIRE(child == again);
+  REQUIRE(child.position() == 0);
+
+  auto values = TestType(child).next(N);
+  REQUIRE(values != TestType(sibling).next(N));
+  REQUIRE(values != rng.next(N));
+}
+
+TEST_CASE("Child seeds use both engine outputs in order", "[reverse]") {
+  const UniformRNG<> rng(Seed{42});
+  ReversiblePCG<> engine;
+  engine.seed(42u);
+
+  const std::uint64_t hi = engine();
+  const std::uint64_t lo = engine();
+  Splitmix64 mix(Splitmix64::mix(hi ^ (lo << 32 | lo >> 32)));
+  mix.discard(7);
+  REQUIRE(rng.child_seed(7) == mix());
+}
+
+TEST_CASE("Thread RNG is distinct per thread", "[reverse]") {
+  auto& rng = thread_rng<NormalRNG<>>();
+  REQUIRE(&rng == &thread_rng<NormalRNG<>>());
+
+  std::vector<double> values;
+  std::thread thread([&] { values = thread_rng<NormalRNG<>>().next(N); });
+  thread.join();
+
+  REQUIRE(values != rng.next(N));
+  REQUIRE(rng.previous(N) != values);
+}
+
+TEMPLATE_LIST_TEST_CASE("Reversible RNG can roll back events", "[reverse]",
+    GeneratorTypes) {
+  EventRNG<TestType> rng;
+
+  std::mt19937 sizes(N);
+  std::uniform_int_distribution<std::size_t> size(0, 100);
+
+  std::vector<EventMark> marks;
+  std::vector<std::vector<typename TestType::result_type>> events;
+  for (std::size_t n = 0; n < 1000; ++n) {
+    marks.push_back(rng.mark());
+    events.push_back(rng.next(size(sizes)));
+  }
+  REQUIRE(rng.events() == 1000);
+
+  rng.rollback(10);
+  REQUIRE(rng.position() == marks[990].position);
+  REQUIRE(rng.next(events[990].size()) == events[990]);
+
+  rng.rollback_to(marks[500]);
+  REQUIRE(rng.events() == 500);
+  REQUIRE(rng.position() == marks[500].position);
+  REQUIRE(rng.next(events[500].size()) == events[500]);
+  REQUIRE_THROWS(rng.rollback_to(marks[600]));
+
+  rng.commit(marks[100]);
+  REQUIRE(rng.events() == 400);
+  REQUIRE_THROWS(rng.rollback_to(marks[99]));
+  REQUIRE_THROWS(rng.rollback(401));
+
+  rng.rollback_to(marks[100]);
+  REQUIRE(rng.events() == 0);
+  REQUIRE(rng.next(events[100].size()) == events[100]);
+
+  rng.mark();
+  const auto mark = rng.mark();
+  rng.commit(1);
+  REQUIRE(rng.events() == 1);
+  REQUIRE_THROWS(rng.commit(2));
+  rng.discard(10);
+  rng.rollback(1);
+  REQUIRE(rng.position() == mark.position);
+}
+
 TEST_CASE("Reversible 32-bit RNG can be reversed with 64-bit output", "[reverse]") {
   ReversibleRNG<UniformDistribution<std::uint64_t>, ReversiblePCG<pcg32>> rng;
 
@@ -166,4 +424,649 @@ TEST_CASE("Reversible 32-bit RNG can be reversed with 64-bit output", "[reverse]
   }
 }
 
+TEST_CASE("Reversible RNG produces two floats per draw", "[reverse]") {
+  using RNG = ReversibleRNG<Blocked<UniformDistribution<float>>>;
+  RNG rng, other;
+  rng.seed(42u);
+  other.seed(42u);
+
+  REQUIRE(RNG::block_size == 2);
+
+  const auto values = rng.next(N + 1);
+
+  // Odd number of values ends in the middle of a draw
+  REQUIRE(rng.previous() == values.back());
+  REQUIRE(rng.next() == values.back());
+
+  std::stringstream ss;
+  ss << rng;
+  ss >> other;
+  REQUIRE(rng == other);
+  REQUIRE(other.previous(N + 1) == values);
+
+  std::mt19937_64 positions(N);
+  std::uniform_int_distribution<std::int64_t> position(0, N);
+  for (std::size_t n = 0; n < 1000; ++n) {
+    const std::int64_t p = position(positions);
+    rng.seek(p);
+    REQUIRE(rng.next() == values[p]);
+    REQUIRE(rng.previous() == values[p]);
+  }
+
+  rng.seek(N + 1);
+  REQUIRE(rng.previous() == values.back());
+  REQUIRE(rng.next() == values.back());
+
+  // Batches that start and end in the middle of a draw
+  rng.seek(3);
+  REQUIRE(rng.next(N - 4) == std::vector<float>(values.begin() + 3, values.end() - 2));
+  REQUIRE(rng.next() == values[N - 1]);
+  REQUIRE(rng.previous(N - 4) == std::vector<float>(values.begin() + 4, values.end() - 1));
+  REQUIRE(rng.previous() == values[3]);
+}
+
+TEST_CASE("Reversible RNG only buffers distributions with several values per draw", "[reverse]") {
+  struct Unbuffered {
+    ReversiblePCG<> engine;
+    NormalDistribution<double> distribution;
+    std::int64_t position;
+  };
+
+  REQUIRE(NormalRNG<double>::block_size == 1);
+  REQUIRE(sizeof(NormalRNG<double>) == sizeof(Unbuffered));
+  REQUIRE(UniformRNG<float>::block_size == 1);
+  REQUIRE(sizeof(ReversibleRNG<Blocked<UniformDistribution<float>>>) > sizeof(UniformRNG<float>));
+}
+
+TEST_CASE("Uniform float RNG uses one draw per value unless blocked", "[reverse]") {
+  UniformRNG<float> rng(Seed{42});
+  ReversiblePCG<> engine;
+  engine.seed(42u);
+  UniformDistribution<float> dist;
+
+  for (std::size_t n = 0; n < 100; ++n) {
+    REQUIRE(rng.next() == dist(engine));
+  }
+}
+
+TEST_CASE("Blocked uniform float RNG uses both halves of a draw", "[reverse]") {
+  ReversibleRNG<Blocked<UniformDistribution<float>>> rng;
+  rng.seed(42u);
+  ReversiblePCG<> engine;
+  engine.seed(42u);
+  const UniformRealDistribution<float> dist;
+
+  rng.discard(N);
+  engine.discard(N / 2);
+
+  const auto block = dist.block(engine());
+  REQUIRE(rng.next() == block[0]);
+  REQUIRE(rng.next() == block[1]);
+  REQUIRE(block[0] != block[1]);
+}
+
+TEMPLATE_LIST_TEST_CASE("Counting adapter can be reversed", "[reverse]",
+    DistributionTypes) {
+  CountingRNG<TestType> rng;
+
+  auto values = rng.next(N);
+
+  REQUIRE(values == rng.previous(N));
+  REQUIRE(rng.position() == 0);
+}
+
+TEMPLATE_LIST_TEST_CASE("Counting adapter can be streamed", "[reverse]",
+    DistributionTypes) {
+  CountingRNG<TestType> rng1, rng2;
+  rng1.discard(N); // Arbitrarily advance the state
+
+  std::stringstream ss;
+  ss << rng1;
+  ss >> rng2;
+
+  REQUIRE(rng1 == rng2);
+  REQUIRE(rng1.previous() == rng2.previous());
+}
+
+TEST_CASE("Counting adapter logs about a byte per value", "[reverse]") {
+  ReversiblePCG<> engine;
+  CountingReversibleAdapter<std::gamma_distribution<double>> dist(0.5, 2.0);
+
+  std::vector<double> values(N);
+  std::generate(values.begin(), values.end(), [&] { return dist(engine); });
+
+  REQUIRE(dist.log_size() == N);
+
+  ReversedEngine reversed(engine);
+  for (auto it = values.rbegin(); it != values.rend(); ++it) {
+    REQUIRE(*it == dist(reversed));
+  }
+  REQUIRE(dist.log_size() == 0);
+}
+
+TEMPLATE_LIST_TEST_CASE("Checkpointed engine can be reversed with fixed intervals", "[reverse]",
+    CheckpointedTypes) {
+  TestType g;
+  g.configure(100, 10);
+
+  std::vector<typename TestType::result_type> values(1000);
+  std::generate(values.begin(), values.end(), [&g] { return g.next(); });
+
+  for (auto it = values.rbegin(); it != values.rend(); ++it) {
+    REQUIRE(*it == g.previous());
+  }
+
+  g.discard(2000); // Oldest checkpoints are overwritten
+  g.configure(100, 10); // Reuse the current state as the start of the sequence
+  g.discard(2000);
+  REQUIRE(g.checkpoints() == 10);
+  REQUIRE_NOTHROW(g.previous());
+  for (std::size_t n = 1; n < 1000; ++n) {
+    g.previous();
+  }
+  REQUIRE_THROWS(g.previous());
+}
+
+TEMPLATE_LIST_TEST_CASE("Checkpointed engine can be reversed with automatic intervals", "[reverse]",
+    CheckpointedTypes) {
+  TestType g1, g2;
+  g1.configure(0, 4);
+
+  std::vector<typename TestType::result_type> values(N);
+  std::generate(values.begin(), values.end(), [&g1] { return g1.next(); });
+
+  REQUIRE(g1.checkpoints() <= 4);
+  REQUIRE(g1.interval() > TestType::default_interval);
+
+  for (auto it = values.rbegin(); it != values.rend(); ++it) {
+    REQUIRE(*it == g1.previous());
+  }
+  REQUIRE(g1 == g2);
+  REQUIRE_THROWS(g1.previous());
+}
+
+TEMPLATE_LIST_TEST_CASE("Indexed RNG can seek", "[reverse]",
+    IndexedTypes) {
+  EventRNG<TestType> rng;
+  rng.configure(64, 128);
+
+  const auto values = rng.next(N);
+
+  REQUIRE(rng.entries() <= 128);
+  REQUIRE(rng.interval() >= N / 128);
+
+  std::mt19937_64 positions(N);
+  std::uniform_int_distribution<std::int64_t> position(0, N - 1);
+  for (std::size_t n = 0; n < 1000; ++n) {
+    const std::int64_t p = position(positions);
+    rng.seek(p);
+    REQUIRE(rng.position() == p);
+    REQUIRE(rng.next() == values[p]);
+    REQUIRE(rng.previous() == values[p]);
+  }
+
+  rng.seek(N);
+  REQUIRE(values == rng.previous(N));
+  REQUIRE(rng.offset() == 0);
+
+  const auto mark = rng.mark();
+  rng.discard(N);
+  rng.rollback_to(mark);
+  REQUIRE(rng.offset() == 0);
+  REQUIRE(rng.next(N) == values);
+}
+
+TEST_CASE("Indexed RNG measures draws per value", "[reverse]") {
+  IndexedRNG<UniformDistribution<std::uint64_t>> rng(0, (std::uint64_t(1) << 63) + 1);
+  rng.configure(1024);
+
+  rng.discard(N);
+
+  // Lemire's method rejects about half of the draws on this range
+  REQUIRE(rng.offset() > std::int64_t(N + N / 2));
+  REQUIRE(rng.interval() < 1024);
+}
+
+TEST_CASE("Indexed RNG matches the plain generator on buffered distributions", "[reverse]") {
+  EventRNG<IndexedRNG<Blocked<UniformDistribution<float>>>> rng(Seed{42});
+  ReversibleRNG<Blocked<UniformDistribution<float>>> plain(Seed{42});
+
+  const auto values = rng.next(N + 1);
+  REQUIRE(values == plain.next(N + 1));
+  REQUIRE(rng.offset() == std::int64_t(N / 2 + 1));
+  REQUIRE(rng.entries() == 0);
+
+  std::mt19937_64 positions(N);
+  std::uniform_int_distribution<std::int64_t> position(0, N);
+  for (std::size_t n = 0; n < 1000; ++n) {
+    const std::int64_t p = position(positions);
+    rng.seek(p);
+    REQUIRE(rng.next() == values[p]);
+    REQUIRE(rng.previous() == values[p]);
+  }
+
+  rng.seek(N / 2);
+  const auto mark = rng.mark();
+  rng.discard(N / 2);
+  rng.rollback_to(mark);
+  REQUIRE(rng.position() == std::int64_t(N / 2));
+  REQUIRE(rng.previous(N / 2) == std::vector<float>(values.begin(), values.begin() + N / 2));
+}
+
+TEMPLATE_TEST_CASE("Shared RNG matches the serial sequence", "[reverse]",
+    UniformDistribution<double>, UniformDistribution<float>, ExponentialDistribution<double>) {
+  SharedReversibleRNG<TestType> shared;
+  ReversibleRNG<TestType> serial;
+  shared.seed(42u);
+  serial.seed(42u);
+
+  constexpr std::size_t block = 1000;
+  std::vector<typename TestType::result_type> values(N);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (auto b = shared.reserve(block); b.position < std::int64_t(N); b = shared.reserve(block)) {
+        shared.values_to(b, values.begin() + b.position);
+      }
+    });
+  }
+  for (auto& thread: threads) {
+    thread.join();
+  }
+
+  REQUIRE(values == serial.next(N));
+
+  const auto first = shared.reserve(block);
+  const auto second = shared.reserve(block);
+  REQUIRE(!shared.release_back(first));
+  REQUIRE(shared.release_back(second));
+  REQUIRE(shared.release_back(first));
+  REQUIRE(shared.reserve(block).position == first.position);
+  serial.seek(first.position);
+  REQUIRE(shared.values(first) == serial.next(block));
+}
+
+TEST_CASE("Cached RNG splits and compares at its position", "[reverse]") {
+  CachedRNG<NormalDistribution<double>> rng(Seed{42}), other(Seed{42});
+  NormalRNG<double> plain(Seed{42});
+  rng.next(10);
+  other.next(10);
+  plain.next(10);
+
+  // Peeking moves the engine past the position of the generator
+  rng.peek(20);
+  REQUIRE(rng == other);
+  REQUIRE(rng.child_seed(3) == plain.child_seed(3));
+  REQUIRE(rng.split(3) == plain.split(3));
+  REQUIRE(rng.ahead(5) == plain.ahead(5));
+
+  other.next();
+  REQUIRE(!(rng == other));
+  REQUIRE(!std::is_convertible<CachedRNG<>&, UniformRNG<>&>::value);
+}
+
+TEMPLATE_LIST_TEST_CASE("Cached RNG can peek in both directions", "[reverse]",
+    CachedTypes) {
+  TestType rng;
+  const auto values = rng.next(N / 10);
+  rng.seek(0);
+
+  std::mt19937_64 steps(N);
+  std::uniform_int_distribution<std::size_t> peek(0, 63);
+  std::uniform_int_distribution<int> step(-40, 60);
+  for (std::size_t n = 0; n < 10000; ++n) {
+    const std::int64_t position = rng.position();
+    const std::size_t k = peek(steps);
+    if (position + std::int64_t(k) < std::int64_t(values.size())) {
+      REQUIRE(rng.peek(k) == values[position + k]);
+    }
+    if (position > std::int64_t(k)) {
+      REQUIRE(rng.peek_back(k) == values[position - 1 - k]);
+    }
+    REQUIRE(rng.position() == position);
+
+    const int s = step(steps);
+    for (int i = 0; i < s && rng.position() + 1 < std::int64_t(values.size()); ++i) {
+      const std::int64_t p = rng.position();
+      REQUIRE(rng.next() == values[p]);
+    }
+    for (int i = 0; i > s && rng.position() > 0; --i) {
+      const std::int64_t p = rng.position();
+      REQUIRE(rng.previous() == values[p - 1]);
+    }
+  }
+  REQUIRE(rng.cached() <= 64);
+
+  rng.seek(N / 20);
+  REQUIRE(rng.next() == values[N / 20]);
+  REQUIRE_THROWS(rng.peek(64));
+
+  TestType other;
+  std::stringstream ss;
+  ss << rng;
+  ss >> other;
+  REQUIRE(other.previous(N / 20 + 1) == std::vector(values.begin(), values.begin() + N / 20 + 1));
+}
+
+TEMPLATE_TEST_CASE("Arena generators match split generators", "[reverse]",
+    (ReversibleRNGArena<NormalDistribution<double>, ReversiblePCG<>, false>),
+    (ReversibleRNGArena<NormalDistribution<double>, ReversiblePCG<>, true>),
+    (ReversibleRNGArena<UniformDistribution<int>, ReversiblePCG<pcg64_fast>, false>),
+    (ReversibleRNGArena<UniformDistribution<float>, ReversiblePCG<>, false>)) {
+  using RNG = ReversibleRNG<typename TestType::distribution_type, typename TestType::engine_type>;
+  constexpr std::size_t size = 1000, steps = 100;
+
+  TestType arena(size);
+  arena.seed(42u);
+  RNG master;
+  master.seed(42u);
+
+  std::vector<std::vector<typename TestType::result_type>> values(steps);
+  for (auto& step: values) {
+    step = arena.step_all_forward();
+  }
+  for (std::size_t i = 0; i < size; i += 99) {
+    auto rng = master.split(i);
+    for (std::size_t step = 0; step < steps; ++step) {
+      REQUIRE(rng.next() == values[step][i]);
+    }
+  }
+
+  const std::vector<std::size_t> indices = {999, 0, 17, 500};
+  std::vector<typename TestType::result_type> forward(indices.size()), backward(indices.size());
+  arena.step_forward(indices, forward.data());
+  REQUIRE(arena.position(17) == std::int64_t(steps + 1));
+  arena.step_backward(indices, backward.data());
+  REQUIRE(forward == backward);
+
+  for (std::size_t step = steps; step-- > 0;) {
+    REQUIRE(arena.step_all_backward() == values[step]);
+  }
+  REQUIRE(arena.position(0) == 0);
+}
+
+TEST_CASE("Monte Carlo paths are identical for any number of threads", "[reverse]") {
+  NormalRNG<> master;
+  constexpr std::size_t paths = 1000, steps = 100;
+
+  const auto simulate = [&](unsigned threads) {
+    std::vector<double> results(paths);
+    parallel_for_paths(master, paths, [&](std::size_t path, NormalRNG<>& rng) {
+      const auto values = rng.next(steps);
+      results[path] = std::accumulate(values.begin(), values.end(), 0.0);
+    }, Parallel{threads});
+    return results;
+  };
+
+  const auto results = simulate(1);
+  REQUIRE(simulate(4) == results);
+  REQUIRE(simulate(3) == results);
+  REQUIRE(results[0] != results[1]);
+
+  auto rng = path_rng(master, 17);
+  const auto values = rng.next(steps);
+  REQUIRE(std::accumulate(values.begin(), values.end(), 0.0) == results[17]);
+  REQUIRE(rng.previous(steps) == values);
+
+  REQUIRE_THROWS_AS(parallel_for_paths(master, paths, [](std::size_t path, NormalRNG<>&) {
+    if (path == 500) {
+      throw std::runtime_error("Path failed.");
+    }
+  }, Parallel{4}), std::runtime_error);
+}
+
+TEST_CASE("Rank RNGs partition the global sequence", "[reverse]") {
+  constexpr std::size_t ranks = 3, length = 1000;
+  UniformRNG<> global;
+  global.seed(42u);
+  const auto values = global.next(ranks * length);
+
+  for (std::size_t rank = 0; rank < ranks; ++rank) {
+    const std::vector block(values.begin() + rank * length, values.begin() + (rank + 1) * length);
+    auto rng = rank_rng(42u, rank, ranks, length);
+    REQUIRE(rng.position() == 0);
+    REQUIRE(rng.next(length) == block);
+    REQUIRE(rng.previous(length) == block);
+    REQUIRE(rank_rng(42u, rank, ranks + 2, length).next(length) == block);
+  }
+
+  REQUIRE_THROWS_AS(rank_rng(42u, ranks, ranks), std::invalid_argument);
+}
+
+#ifdef __unix__
+TEST_CASE("Rank RNGs agree across processes", "[reverse]") {
+  constexpr std::size_t ranks = 3, length = 1000;
+  std::vector<double> values(ranks * length);
+
+  std::vector<pid_t> children;
+  std::vector<int> pipes;
+  for (std::size_t rank = 0; rank < ranks; ++rank) {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      close(fds[0]);
+      const auto block = rank_rng<NormalRNG<>>(7u, rank, ranks).next(length);
+      const auto bytes = block.size() * sizeof(double);
+      _exit(write(fds[1], block.data(), bytes) == ssize_t(bytes) ? 0 : 1);
+    }
+    close(fds[1]);
+    children.push_back(pid);
+    pipes.push_back(fds[0]);
+  }
+
+  for (std::size_t rank = 0; rank < ranks; ++rank) {
+    auto* data = reinterpret_cast<char*>(values.data() + rank * length);
+    std::size_t bytes = 0;
+    for (ssize_t n; bytes < length * sizeof(double)
+         && (n = read(pipes[rank], data + bytes, length * sizeof(double) - bytes)) > 0;) {
+      bytes += n;
+    }
+    close(pipes[rank]);
+
+    int status;
+    REQUIRE(waitpid(children[rank], &status, 0) == children[rank]);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE(bytes == length * sizeof(double));
+
+    auto rng = rank_rng<NormalRNG<>>(7u, rank, ranks);
+    REQUIRE(rng.next(length) == std::vector(values.begin() + rank * length,
+                                            values.begin() + (rank + 1) * length));
+  }
+}
+#endif
+
+#ifdef __unix__
+TEST_CASE("Mapped file reports the error of the failed call", "[reverse]") {
+  // A device cannot be resized
+  std::string message;
+  try {
+    MappedFile file("/dev/null", 4096);
+  } catch (const std::runtime_error& e) {
+    message = e.what();
+  }
+  REQUIRE(message == std::string("Cannot resize /dev/null: ") + std::strerror(EINVAL));
+}
+
+TEMPLATE_TEST_CASE("Snapshot store resumes generators", "[reverse]",
+    (UniformRNG<double>), (NormalRNG<float>),
+    (ReversibleRNG<UniformDistribution<double>, Xoshiro256>)) {
+  const auto path = std::filesystem::temp_directory_path() / "reverse_snapshot_test.bin";
+  std::filesystem::remove(path);
+
+  constexpr std::size_t count = 1000;
+  std::vector<TestType> rngs(count);
+  {
+    SnapshotStore<TestType> store(path.string(), count);
+    REQUIRE(store.size() == count);
+    for (std::size_t i = 0; i < count; ++i) {
+      rngs[i].next(i);
+      store.put(i, rngs[i]);
+    }
+    store.commit(count / 2, count / 2);
+    store.commit();
+  }
+  REQUIRE(std::filesystem::file_size(path) == count * TestType::binary_size);
+
+  SnapshotStore<TestType> store(path.string());
+  REQUIRE(store.size() == count);
+  for (const std::size_t i: {std::size_t(0), count / 3, count - 1}) {
+    auto rng = store.get(i);
+    REQUIRE(rng == rngs[i]);
+    REQUIRE(rng.next(N) == rngs[i].next(N));
+
+    // Resuming writes back in place
+    store.put(i, rng);
+    REQUIRE(store.get(i) == rngs[i]);
+  }
+  REQUIRE_THROWS_AS(store.get(count), std::out_of_range);
+
+  std::filesystem::remove(path);
+}
+#endif
+
+#ifdef __unix__
+TEMPLATE_TEST_CASE("Random tape replays the generator sequence", "[reverse]",
+    NormalRNG<double>, UniformRNG<float>) {
+  const auto path = std::filesystem::temp_directory_path() / "reverse_tape_test.bin";
+
+  TestType rng;
+  rng.next(N / 2);
+  RandomTape<TestType> tape(rng, N, path.string(), Parallel{4});
+  REQUIRE(tape.first() == rng.position());
+  REQUIRE(tape.last() == rng.position() + std::int64_t(N));
+
+  // Replays the window and regenerates past both of its ends
+  const auto values = rng.next(N + 100);
+  tape.seek(rng.position() - std::int64_t(N) - 100);
+  for (int replay = 0; replay < 3; ++replay) {
+    REQUIRE(tape.next(N + 100) == values);
+    REQUIRE(tape.previous(N + 100) == values);
+  }
+  rng.seek(tape.first());
+  REQUIRE(tape.previous(N / 2) == rng.previous(N / 2));
+
+  tape.seek(tape.first() + 10);
+  REQUIRE(tape.next() == values[10]);
+
+  // Misses on either side of the window use their own copy of the generator
+  rng.seek(tape.first());
+  const auto before = rng.previous();
+  for (int miss = 0; miss < 3; ++miss) {
+    tape.seek(tape.last());
+    REQUIRE(tape.next() == values[N]);
+    tape.seek(tape.first());
+    REQUIRE(tape.previous() == before);
+  }
+
+  std::filesystem::remove(path);
+}
+#endif
+
+TEMPLATE_TEST_CASE("Prefetching RNG matches the serial sequence", "[reverse]",
+    UniformDistribution<double>, UniformDistribution<int>, NormalDistribution<double>) {
+  PrefetchingReversibleRNG<TestType, ReversiblePCG<>, 64> rng;
+  ReversibleRNG<TestType> serial;
+  rng.seed(42u);
+  serial.seed(42u);
+
+  const auto values = serial.next(N / 10);
+  for (const auto value: values) {
+    REQUIRE(rng.next() == value);
+  }
+  for (std::size_t n = values.size(); n-- > 0;) {
+    REQUIRE(rng.previous() == values[n]);
+  }
+
+  // Random walk over window boundaries and direction changes
+  std::mt19937_64 steps(N);
+  std::uniform_int_distribution<int> steps_per_walk(1, 200);
+  std::bernoulli_distribution forward(0.5);
+  for (std::size_t n = 0; n < 1000; ++n) {
+    const bool next = forward(steps) || rng.position() < 200;
+    for (int step = steps_per_walk(steps); step > 0; --step) {
+      const std::int64_t position = rng.position();
+      if (next) {
+        REQUIRE(rng.next() == values[position]);
+      } else {
+        REQUIRE(rng.previous() == values[position - 1]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Prefetching RNG continues from the position of a generator", "[reverse]") {
+  using Prefetching = PrefetchingReversibleRNG<NormalDistribution<double>, ReversiblePCG<>, 64>;
+  REQUIRE(!std::is_constructible<Prefetching, Prefetching&>::value);
+
+  NormalRNG<double> serial(Seed{42});
+  const auto values = serial.next(200);
+  serial.seek(100);
+
+  Prefetching rng(serial);
+  REQUIRE(rng.position() == 100);
+  for (std::size_t n = 100; n < values.size(); ++n) {
+    REQUIRE(rng.next() == values[n]);
+  }
+  for (std::size_t n = values.size(); n-- > 0;) {
+    REQUIRE(rng.previous() == values[n]);
+  }
+}
+
+#ifdef __unix__
+TEST_CASE("Prefetching RNG helper sleeps while the queue is full", "[reverse]") {
+  PrefetchingReversibleRNG<UniformDistribution<double>, ReversiblePCG<>, 64> rng;
+  rng.next();
+
+  // Process CPU time of all threads while nobody reads
+  const std::clock_t start = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  const double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+  REQUIRE(seconds < 0.05);
+}
+#endif
+
+TEMPLATE_TEST_CASE("Reversible stream can be reversed on interleaved distributions", "[reverse]",
+    ReversiblePCG<pcg64>, ReversiblePCG<pcg64_fast>, ReversibleMersenne,
+    CheckpointedEngine<std::mt19937_64>) {
+  ReversibleStream<TestType> stream;
+  UniformDistribution<int> uniform(-10, 10);
+  NormalDistribution<double> normal(1.0, 2.0);
+  ExponentialDistribution<float> exponential(0.5f);
+
+  std::vector<int> uniforms;
+  std::vector<double> normals;
+  std::vector<float> exponentials;
+  for (std::size_t n = 0; n < N / 10; ++n) {
+    uniforms.push_back(stream.next(uniform));
+    normals.push_back(stream.next(normal));
+    exponentials.push_back(stream.next(exponential));
+  }
+  const auto batch = stream.next(normal, N / 10);
+
+  REQUIRE(stream.position() == std::int64_t(4 * (N / 10)));
+  REQUIRE(stream.previous(normal, N / 10) == batch);
+  for (std::size_t n = N / 10; n-- > 0;) {
+    REQUIRE(stream.previous(exponential) == exponentials[n]);
+    REQUIRE(stream.previous(normal) == normals[n]);
+    REQUIRE(stream.previous(uniform) == uniforms[n]);
+  }
+  REQUIRE(stream.position() == 0);
+  REQUIRE(stream.log_size() == 0);
+}
+
+TEST_CASE("Reversible stream can be streamed", "[reverse]") {
+  ReversibleStream<> stream1, stream2;
+  stream1.next(NormalDistribution<>(), N);
+
+  std::stringstream ss;
+  ss << stream1;
+  ss >> stream2;
+
+  REQUIRE(stream1 == stream2);
+  REQUIRE(stream1.next(UniformDistribution<>()) == stream2.next(UniformDistribution<>()));
+}
+
 } // namespace reverse